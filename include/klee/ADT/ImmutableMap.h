@@ -97,6 +97,7 @@ namespace klee {
     }
 
     static size_t getAllocated() { return Tree::allocated; }
+    static size_t getNodeSize() { return Tree::getNodeSize(); }
   };
 
 }
@@ -58,6 +58,8 @@ namespace klee {
     iterator upper_bound(const key_type &key) const;
 
     static size_t getAllocated() { return allocated; }
+    // size of a node, i.e. the memory needed per element unless shared
+    static size_t getNodeSize();
 
   private:
     class Node;
@@ -243,6 +245,11 @@ namespace klee {
   template<class K, class V, class KOV, class CMP> 
   size_t ImmutableTree<K,V,KOV,CMP>::allocated = 0;
 
+  template<class K, class V, class KOV, class CMP>
+  size_t ImmutableTree<K,V,KOV,CMP>::getNodeSize() {
+    return sizeof(Node);
+  }
+
   template<class K, class V, class KOV, class CMP>
   ImmutableTree<K,V,KOV,CMP>::Node::Node() 
     : left(&terminator), 
@@ -19,6 +19,8 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <array>
+#include <cstdint>
 #include <sstream>
 #include <set>
 #include <vector>
@@ -95,6 +97,10 @@ public:
 
   /// The type of an expression is simply its width, in bits. 
   typedef unsigned Width; 
+
+  /// 128-bit hash of the structure and contents of an expression, see
+  /// contentHash().
+  typedef std::array<std::uint64_t, 2> ContentHash;
   
   static const Width InvalidWidth = 0;
   static const Width Bool = 1;
@@ -179,6 +185,15 @@ public:
 protected:  
   unsigned hashValue;
 
+private:
+  /// cache for contentHash(), all zero until it is computed (adds 16 bytes
+  /// to every expression, also if content hashes are never used)
+  mutable ContentHash contentHashValue = {};
+
+  void computeContentHash() const;
+
+protected:
+
   /// Compares `b` to `this` Expr and determines how they are ordered
   /// (ignoring their kid expressions - i.e. those returned by `getKid()`).
   ///
@@ -224,6 +239,23 @@ public:
   /// (Re)computes the hash of the current expression.
   /// Returns the hash value. 
   virtual unsigned computeHash();
+
+  /// Returns a 128-bit hash of the structure and contents of the current
+  /// expression. In contrast to hash(), collisions between structurally
+  /// different expressions are unlikely and the hash does not depend on the
+  /// identity of any object, so that it can be used to compare expressions
+  /// by their contents (e.g. in memory fingerprints). The hash is computed on
+  /// first use and cached afterwards.
+  const ContentHash &contentHash() const {
+    if (!hasContentHash())
+      computeContentHash();
+    return contentHashValue;
+  }
+
+  /// Whether contentHash() has been computed already.
+  bool hasContentHash() const {
+    return contentHashValue[0] != 0 || contentHashValue[1] != 0;
+  }
   
   /// Compares `b` to `this` Expr for structural equivalence.
   ///
@@ -454,6 +486,10 @@ class UpdateNode {
   // cache instead of recalc
   unsigned hashValue;
 
+  // cache for contentHash(), all zero until it is computed (16 bytes per
+  // update, see Expr::contentHashValue)
+  mutable Expr::ContentHash contentHashValue = {};
+
 public:
   const ref<UpdateNode> next;
   ref<Expr> index, value;
@@ -474,6 +510,15 @@ public:
   int compare(const UpdateNode &b) const;  
   unsigned hash() const { return hashValue; }
 
+  /// 128-bit hash of this update and all previous updates in the sequence
+  /// (see Expr::contentHash())
+  const Expr::ContentHash &contentHash() const;
+
+  /// Whether contentHash() has been computed already.
+  bool hasContentHash() const {
+    return contentHashValue[0] != 0 || contentHashValue[1] != 0;
+  }
+
   UpdateNode() = delete;
   ~UpdateNode() = default;
 
@@ -500,6 +545,10 @@ public:
 private:
   unsigned hashValue;
 
+  // cache for contentHash(), all zero until it is computed (16 bytes per
+  // array, see Expr::contentHashValue)
+  mutable Expr::ContentHash contentHashValue = {};
+
   // FIXME: Make =delete when we switch to C++11
   Array(const Array& array);
 
@@ -532,6 +581,15 @@ public:
   /// ComputeHash must take into account the name, the size, the domain, and the range
   unsigned computeHash();
   unsigned hash() const { return hashValue; }
+
+  /// 128-bit hash of name, size, domain, range and constant values of the
+  /// array (see Expr::contentHash())
+  const Expr::ContentHash &contentHash() const;
+
+  /// Whether contentHash() has been computed already.
+  bool hasContentHash() const {
+    return contentHashValue[0] != 0 || contentHashValue[1] != 0;
+  }
   friend class ArrayCache;
 };
 
@@ -559,6 +617,10 @@ public:
 
   int compare(const UpdateList &b) const;
   unsigned hash() const;
+
+  /// 128-bit hash of the root array and all updates (see
+  /// Expr::contentHash())
+  Expr::ContentHash contentHash() const;
 };
 
 /// Class representing a one byte read from an array. 
@@ -41,6 +41,9 @@ namespace klee {
     int *operands;
     /// Destination register index.
     unsigned dest;
+    /// Id of the basic block that contains the instruction (index into
+    /// KFunction::basicBlocks).
+    unsigned basicBlockId;
 
   public:
     virtual ~KInstruction();
@@ -15,6 +15,7 @@
 
 #include "llvm/ADT/ArrayRef.h"
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
@@ -27,6 +28,7 @@ namespace llvm {
   class Constant;
   class DataLayout;
   class Function;
+  class GlobalVariable;
   class Instruction;
   class Module;
   class Value;
@@ -52,16 +54,55 @@ namespace klee {
 
     std::map<llvm::BasicBlock*, unsigned> basicBlockEntry;
 
+    /// Dense per basic block information, indexed by basic block id (the
+    /// position of the basic block within the function).
+    struct KBasicBlock {
+      /// Index of the first instruction of the basic block in instructions.
+      unsigned entry;
+      /// Live registers *before* executing the basic block, stored as spans
+      /// [begin, end) of liveInstructions and liveArguments.
+      unsigned liveInstBegin, liveInstEnd;
+      unsigned liveArgBegin, liveArgEnd;
+      /// Whether a cycle of the control flow graph is entered through this
+      /// basic block (see LoopHeaderPass).
+      bool isLoopHeader;
+      /// Whether the innermost loop containing this basic block is known to
+      /// terminate (see FiniteLoopPass).
+      bool isInFiniteLoop;
+      /// Innermost loop (index into loops) that contains this basic block.
+      unsigned loop;
+      /// Basic blocks (sorted ids) of the irreducible cycle entered through
+      /// this basic block, stored as span [cycleBegin, cycleEnd) of
+      /// cycleBlocks (see LoopHeaderPass::getIrreducibleCycle()).
+      unsigned cycleBegin, cycleEnd;
+    };
+    std::vector<KBasicBlock> basicBlocks;
+
+    /// Natural loops of the function (as computed by LLVM's LoopInfo) in
+    /// preorder, i.e. every loop is preceded by its parent. The first entry
+    /// represents the function body itself (depth 0).
+    struct KLoop {
+      unsigned parent;
+      unsigned depth;
+    };
+    std::vector<KLoop> loops;
+    std::vector<const KInstruction *> liveInstructions;
+    std::vector<unsigned> liveArguments;
+    std::vector<unsigned> cycleBlocks;
+
     struct liveset_t {
-      std::vector<const KInstruction *> inst;
-      std::vector<unsigned> args;
+      llvm::ArrayRef<const KInstruction *> inst;
+      llvm::ArrayRef<unsigned> args;
     };
-    std::map<const llvm::BasicBlock *, liveset_t> basicBlockLiveSet;
 
     /// Whether instructions in this function should count as
     /// "coverable" for statistics and search heuristics.
     bool trackCoverage;
 
+    /// Classification of the function for infinite loop detection, a
+    /// bitfield of MemoryState::FunctionClass values (0 if unclassified).
+    std::uint8_t functionClass = 0;
+
   public:
     explicit KFunction(llvm::Function*, KModule *);
     KFunction(const KFunction &) = delete;
@@ -71,16 +112,44 @@ namespace klee {
 
     unsigned getArgRegister(unsigned index) const { return index; }
 
-    /// @brief Set which locals are live *before* executing bb.
-    void setLiveLocals(const llvm::BasicBlock *bb,
-                       std::vector<const KInstruction *> &&inst,
-                       std::vector<unsigned> &&args) {
-      basicBlockLiveSet[bb] = {.inst = std::move(inst), .args = std::move(args)};
+    /// @brief Get id of bb (requires a map lookup, prefer
+    /// KInstruction::basicBlockId on hot paths).
+    unsigned getBasicBlockId(const llvm::BasicBlock &bb) const;
+
+    /// @brief Set which locals are live *before* executing the basic block
+    /// with the given id. Has to be called in ascending order of ids.
+    void setLiveLocals(unsigned id,
+                       const std::vector<const KInstruction *> &inst,
+                       const std::vector<unsigned> &args);
+
+    /// @brief Get set of locals live *before* executing the basic block
+    /// with the given id.
+    liveset_t getLiveLocals(unsigned id) const {
+      const KBasicBlock &kbb = basicBlocks[id];
+      llvm::ArrayRef<const KInstruction *> inst(liveInstructions);
+      llvm::ArrayRef<unsigned> args(liveArguments);
+      return {
+          inst.slice(kbb.liveInstBegin, kbb.liveInstEnd - kbb.liveInstBegin),
+          args.slice(kbb.liveArgBegin, kbb.liveArgEnd - kbb.liveArgBegin)};
     }
 
     /// @brief Get set of locals live *before* executing bb.
-    const liveset_t &getLiveLocals(const llvm::BasicBlock &bb) const {
-      return basicBlockLiveSet.at(&bb);
+    liveset_t getLiveLocals(const llvm::BasicBlock &bb) const {
+      return getLiveLocals(getBasicBlockId(bb));
+    }
+
+    /// @brief Set the basic blocks of the irreducible cycle entered through
+    /// the basic block with the given id. Has to be called in ascending order
+    /// of ids.
+    void setIrreducibleCycle(unsigned id, std::vector<unsigned> cycle);
+
+    /// @brief Get the ids (sorted) of the basic blocks of the irreducible
+    /// cycle entered through the basic block with the given id (empty if it
+    /// is not the entry point of one).
+    llvm::ArrayRef<unsigned> getIrreducibleCycle(unsigned id) const {
+      const KBasicBlock &kbb = basicBlocks[id];
+      return llvm::ArrayRef<unsigned>(cycleBlocks)
+          .slice(kbb.cycleBegin, kbb.cycleEnd - kbb.cycleBegin);
     }
   };
 
@@ -125,6 +194,10 @@ namespace klee {
     // Functions which are part of KLEE runtime
     std::set<const llvm::Function*> internalFunctions;
 
+    // Global variables that are excluded from the memory fingerprint
+    // (-infinite-loop-detection-ignore-write-only-globals)
+    std::set<const llvm::GlobalVariable*> excludedGlobals;
+
   private:
     // Mark function with functionName as part of the KLEE runtime
     void addInternalFunction(const char* functionName);
@@ -0,0 +1,78 @@
+//===-- FastHash.h ----------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_FASTHASH_H
+#define KLEE_FASTHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace klee {
+
+/// Non-cryptographic 128-bit hashing in the style of wyhash, shared by the
+/// fast128 fingerprint backend and Expr::contentHash().
+struct FastHash {
+  // secrets taken from wyhash (public domain)
+  static constexpr std::uint64_t secret0 = 0xa0761d6478bd642full;
+  static constexpr std::uint64_t secret1 = 0xe7037ed1a0b428dbull;
+  static constexpr std::uint64_t secret2 = 0x8ebc6af09c88c6e3ull;
+  static constexpr std::uint64_t secret3 = 0x589965cc75374cc3ull;
+
+  /// 64x64->128 bit multiplication, folded to 64 bits
+  static std::uint64_t mix(std::uint64_t a, std::uint64_t b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+  }
+
+  static std::uint64_t read64(const std::uint8_t *p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  /// Hash size bytes starting at data into the 16 bytes at result, using two
+  /// lanes that are updated with one mix() each per 16 bytes of input.
+  static void hash128(const std::uint8_t *data, std::size_t size,
+                      std::uint8_t *result) {
+    std::uint64_t lo = secret0 ^ size;
+    std::uint64_t hi = secret1 ^ (static_cast<std::uint64_t>(size) << 32);
+
+    // mix() is zero whenever one of its operands is, e.g. for an input word
+    // equal to secret1. Like wyhash's "condom" mode, each lane is therefore
+    // xored with the product instead of being replaced by it, so that such a
+    // word leaves the lane unchanged rather than erasing all earlier input.
+    // A crafted word can still keep its partner word out of one lane; as
+    // documented in the README, this hash does not withstand crafted inputs.
+    auto round = [&lo, &hi](std::uint64_t a, std::uint64_t b) {
+      std::uint64_t newLo = lo ^ mix(a ^ secret1, b ^ lo);
+      std::uint64_t newHi = hi ^ mix(b ^ secret2, a ^ hi);
+      lo = newLo;
+      hi = newHi;
+    };
+
+    for (; size >= 16; data += 16, size -= 16) {
+      round(read64(data), read64(data + 8));
+    }
+    if (size > 0) {
+      std::uint8_t tail[16] = {};
+      std::memcpy(tail, data, size);
+      round(read64(tail), read64(tail + 8));
+    }
+
+    std::uint64_t h0 = mix(lo ^ secret3, hi ^ secret0);
+    std::uint64_t h1 = mix(hi ^ secret2, lo ^ secret1);
+    std::memcpy(result, &h0, sizeof(h0));
+    std::memcpy(result + sizeof(h0), &h1, sizeof(h1));
+  }
+};
+
+} // namespace klee
+
+#endif /* KLEE_FASTHASH_H */
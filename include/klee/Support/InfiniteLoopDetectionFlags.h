@@ -18,6 +18,78 @@ extern llvm::cl::opt<bool> InfiniteLoopDetectionTruncateOnFork;
 
 extern llvm::cl::opt<bool> InfiniteLoopDetectionDisableTwoPredecessorOpt;
 
+extern llvm::cl::opt<bool> InfiniteLoopDetectionLoopHeadersOnly;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionSkipFiniteLoops;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionTruncateLoops;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionIgnoreWriteOnlyGlobals;
+
+extern llvm::cl::opt<std::string> InfiniteLoopDetectionFunctionLists;
+
+enum InfiniteLoopDetectionDuplicateStatesType {
+  DUPLICATES_KEEP,
+  DUPLICATES_TERMINATE,
+  DUPLICATES_DEPRIORITIZE
+};
+
+extern llvm::cl::opt<InfiniteLoopDetectionDuplicateStatesType>
+    InfiniteLoopDetectionDuplicateStates;
+
+extern llvm::cl::opt<unsigned> InfiniteLoopDetectionMaxLoopIterations;
+
+enum InfiniteLoopDetectionSuspectedLoopsType {
+  SUSPECTED_TERMINATE,
+  SUSPECTED_DEPRIORITIZE
+};
+
+extern llvm::cl::opt<InfiniteLoopDetectionSuspectedLoopsType>
+    InfiniteLoopDetectionSuspectedLoops;
+
+enum InfiniteLoopDetectionAlgorithmType {
+  DETECT_WITH_TRACE,
+  DETECT_WITH_BRENT
+};
+
+extern llvm::cl::opt<InfiniteLoopDetectionAlgorithmType>
+    InfiniteLoopDetectionAlgorithm;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionCompactTrace;
+
+extern llvm::cl::opt<unsigned> InfiniteLoopDetectionMaxFrameEntries;
+
+enum InfiniteLoopDetectionEvictionType { EVICT_OLDEST, EVICT_SAMPLING };
+
+extern llvm::cl::opt<InfiniteLoopDetectionEvictionType>
+    InfiniteLoopDetectionEviction;
+
+enum InfiniteLoopDetectionWriteHashingType {
+  HASH_WRITES_PER_BYTE,
+  HASH_WRITES_PER_CHUNK
+};
+
+extern llvm::cl::opt<InfiniteLoopDetectionWriteHashingType>
+    InfiniteLoopDetectionWriteHashing;
+
+extern llvm::cl::opt<unsigned> InfiniteLoopDetectionChunkSize;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionCacheObjectContributions;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionLazyWrites;
+
+extern llvm::cl::opt<unsigned> InfiniteLoopDetectionSymbolicWriteRange;
+
+enum InfiniteLoopDetectionFingerprintType {
+  FINGERPRINT_BLAKE2B,
+  FINGERPRINT_FAST128
+};
+
+extern llvm::cl::opt<InfiniteLoopDetectionFingerprintType>
+    InfiniteLoopDetectionFingerprint;
+
+extern llvm::cl::opt<bool> InfiniteLoopDetectionHashExprAsText;
+
 extern llvm::cl::opt<bool> InfiniteLoopLogStateJSON;
 
 #ifdef HAVE_ZLIB_H
@@ -121,6 +121,10 @@ extern "C" {
   void klee_clear_memory_state();
   void klee_disable_memory_state();
   void klee_enable_memory_state();
+  /* Ignore all changes to the memory object pointed to by ptr in the infinite
+     loop detection of the current path (and those forked from it), e.g. for
+     counters that do not influence the execution. */
+  void klee_exclude_from_memory_state(void *ptr);
   void klee_dump_memory_trace();
 
   /* Return a possible constant value for the input expression. This
@@ -312,14 +312,14 @@ void AddressSpace::copyOutConcretes() {
   }
 }
 
-bool AddressSpace::copyInConcretes() {
+bool AddressSpace::copyInConcretes(const ConcreteChangeCallback &onChange) {
   for (auto &obj : objects) {
     const MemoryObject *mo = obj.first;
 
     if (!mo->isUserSpecified) {
       const auto &os = obj.second;
 
-      if (!copyInConcrete(mo, os.get(), mo->address))
+      if (!copyInConcrete(mo, os.get(), mo->address, onChange))
         return false;
     }
   }
@@ -328,14 +328,20 @@ bool AddressSpace::copyInConcretes() {
 }
 
 bool AddressSpace::copyInConcrete(const MemoryObject *mo, const ObjectState *os,
-                                  uint64_t src_address) {
+                                  uint64_t src_address,
+                                  const ConcreteChangeCallback &onChange) {
   auto address = reinterpret_cast<std::uint8_t*>(src_address);
   if (memcmp(address, os->concreteStore, mo->size) != 0) {
     if (os->readOnly) {
       return false;
     } else {
+      if (onChange)
+        onChange(mo, os, false);
       ObjectState *wos = getWriteable(mo, os);
       memcpy(wos->concreteStore, address, mo->size);
+      wos->invalidateFingerprintContributions();
+      if (onChange)
+        onChange(mo, wos, true);
     }
   }
   return true;
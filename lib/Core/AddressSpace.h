@@ -16,6 +16,8 @@
 #include "klee/ADT/ImmutableMap.h"
 #include "klee/System/Time.h"
 
+#include <functional>
+
 namespace klee {
   class ExecutionState;
   class MemoryObject;
@@ -35,6 +37,13 @@ namespace klee {
   typedef ImmutableMap<const MemoryObject *, ref<ObjectState>, MemoryObjectLT>
       MemoryMap;
 
+  /// Called for each object that is modified by copying in concrete values,
+  /// once with its ObjectState before (modified = false) and once after the
+  /// modification (modified = true).
+  typedef std::function<void(const MemoryObject *mo, const ObjectState *os,
+                             bool modified)>
+      ConcreteChangeCallback;
+
   class AddressSpace {
   private:
     /// Epoch counter used to control ownership of objects.
@@ -134,18 +143,21 @@ namespace klee {
     /// potentially copied) if the memory values are different from
     /// the current concrete values.
     ///
+    /// \param onChange Called for each modified ObjectState (optional).
     /// \retval true The copy succeeded. 
     /// \retval false The copy failed because a read-only object was modified.
-    bool copyInConcretes();
+    bool copyInConcretes(const ConcreteChangeCallback &onChange = {});
 
     /// Updates the memory object with the raw memory from the address
     ///
     /// @param mo The MemoryObject to update
     /// @param os The associated memory state containing the actual data
     /// @param src_address the address to copy from
+    /// @param onChange Called if the object is modified (optional)
     /// @return
     bool copyInConcrete(const MemoryObject *mo, const ObjectState *os,
-                        uint64_t src_address);
+                        uint64_t src_address,
+                        const ConcreteChangeCallback &onChange = {});
   };
 } // End klee namespace
 
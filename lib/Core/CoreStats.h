@@ -47,6 +47,29 @@ namespace stats {
   /// distance to a function return.
   extern Statistic minDistToReturn;
 
+  /// Number of times a stack frame of a MemoryTrace exceeded its budget
+  /// (-infinite-loop-detection-max-frame-entries) and was thinned out.
+  extern Statistic traceEvictions;
+
+  /// Number of MemoryTrace entries removed by these evictions.
+  extern Statistic traceEvictedEntries;
+
+  /// Number of MemoryTrace entries removed when leaving a loop
+  /// (-infinite-loop-detection-truncate-loops).
+  extern Statistic traceTruncatedEntries;
+
+  /// Number of states that reached a loop header in the same configuration
+  /// as another state (-infinite-loop-detection-duplicate-states).
+  extern Statistic duplicateStates;
+
+  /// Number of states that exceeded the iteration budget of a loop
+  /// (-infinite-loop-detection-max-loop-iterations).
+  extern Statistic suspectedLoops;
+
+  /// Highest number of iterations of a loop that has been left (with
+  /// -infinite-loop-detection-max-loop-iterations).
+  extern Statistic maxLoopIterations;
+
 }
 }
 
@@ -18,13 +18,16 @@
 #include "klee/Module/KInstruction.h"
 #include "klee/Module/KModule.h"
 #include "klee/Support/Casting.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
 #include "klee/Support/OptionCategories.h"
 
 #include "llvm/IR/Function.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iomanip>
 #include <map>
 #include <set>
@@ -59,7 +62,9 @@ StackFrame::StackFrame(const StackFrame &s)
     callPathNode(s.callPathNode),
     allocas(s.allocas),
     minDistToUncoveredOnReturn(s.minDistToUncoveredOnReturn),
-    varargs(s.varargs) {
+    varargs(s.varargs),
+    callersFingerprint(s.callersFingerprint),
+    validCallersFingerprint(s.validCallersFingerprint) {
   locals = new Cell[s.kf->numRegisters];
   for (unsigned i=0; i<s.kf->numRegisters; i++)
     locals[i] = s.locals[i];
@@ -98,6 +103,7 @@ ExecutionState::ExecutionState(const ExecutionState& state):
     prevPC(state.prevPC),
     stack(state.stack),
     incomingBBIndex(state.incomingBBIndex),
+    incomingBBId(state.incomingBBId),
     depth(state.depth),
     addressSpace(state.addressSpace),
     constraints(state.constraints),
@@ -160,6 +166,74 @@ llvm::raw_ostream &klee::operator<<(llvm::raw_ostream &os, const MemoryMap &mm)
   return os;
 }
 
+/// Compute the maximal ranges [begin, end) of bytes that differ between two
+/// ObjectStates of the same MemoryObject. Chunks with equal cached
+/// fingerprint contributions (-infinite-loop-detection-cache-object-
+/// contributions) are skipped without reading their bytes.
+static void
+getDifferingRanges(const ObjectState &a, const ObjectState &b,
+                   std::vector<std::pair<unsigned, unsigned>> &ranges) {
+  unsigned chunkSize = std::max(1u, InfiniteLoopDetectionChunkSize.getValue());
+  bool cached = !a.validFingerprintContributions.empty() &&
+                !b.validFingerprintContributions.empty();
+
+  for (unsigned chunk = 0; chunk < a.size; chunk += chunkSize) {
+    unsigned chunkEnd = std::min(chunk + chunkSize, a.size);
+
+    if (cached) {
+      std::size_t index = chunk / chunkSize;
+      if (a.validFingerprintContributions[index] &&
+          b.validFingerprintContributions[index] &&
+          a.fingerprintContributions[index] ==
+              b.fingerprintContributions[index])
+        continue;
+    }
+
+    const uint8_t *aBytes = a.readConcreteRange(chunk, chunkEnd);
+    const uint8_t *bBytes = b.readConcreteRange(chunk, chunkEnd);
+    if (aBytes && bBytes && !memcmp(aBytes, bBytes, chunkEnd - chunk))
+      continue;
+
+    for (unsigned i = chunk; i < chunkEnd; i++) {
+      if (a.read8(i) == b.read8(i))
+        continue;
+      if (!ranges.empty() && ranges.back().second == i)
+        ranges.back().second = i + 1;
+      else
+        ranges.emplace_back(i, i + 1);
+    }
+  }
+}
+
+/// Widen ranges to the chunks they overlap with
+/// (-infinite-loop-detection-write-hashing=chunk) and coalesce them, so that
+/// the contribution of each chunk is unregistered and registered only once.
+static std::vector<std::pair<unsigned, unsigned>>
+getRegistrationRanges(const ObjectState &os,
+                      const std::vector<std::pair<unsigned, unsigned>> &ranges) {
+  if (InfiniteLoopDetectionWriteHashing != HASH_WRITES_PER_CHUNK)
+    return ranges;
+
+  unsigned chunkSize = std::max(1u, InfiniteLoopDetectionChunkSize.getValue());
+  std::vector<std::pair<unsigned, unsigned>> result;
+  for (const auto &range : ranges) {
+    unsigned begin = range.first - range.first % chunkSize;
+    unsigned end = std::min(
+        range.second + (chunkSize - range.second % chunkSize) % chunkSize,
+        os.size);
+    if (!result.empty() && result.back().second >= begin)
+      result.back().second = std::max(result.back().second, end);
+    else
+      result.emplace_back(begin, end);
+  }
+  return result;
+}
+
+static ref<Expr> getRangeAddress(const MemoryObject *mo, unsigned offset) {
+  return ConstantExpr::create(mo->address + offset,
+                              Context::get().getPointerWidth());
+}
+
 bool ExecutionState::merge(const ExecutionState &b) {
   if (DebugLogStateMerge)
     llvm::errs() << "-- attempting merge of A:" << this << " with B:" << &b
@@ -187,42 +261,9 @@ bool ExecutionState::merge(const ExecutionState &b) {
       return false;
   }
 
-  std::set< ref<Expr> > aConstraints(constraints.begin(), constraints.end());
-  std::set< ref<Expr> > bConstraints(b.constraints.begin(), 
-                                     b.constraints.end());
-  std::set< ref<Expr> > commonConstraints, aSuffix, bSuffix;
-  std::set_intersection(aConstraints.begin(), aConstraints.end(),
-                        bConstraints.begin(), bConstraints.end(),
-                        std::inserter(commonConstraints, commonConstraints.begin()));
-  std::set_difference(aConstraints.begin(), aConstraints.end(),
-                      commonConstraints.begin(), commonConstraints.end(),
-                      std::inserter(aSuffix, aSuffix.end()));
-  std::set_difference(bConstraints.begin(), bConstraints.end(),
-                      commonConstraints.begin(), commonConstraints.end(),
-                      std::inserter(bSuffix, bSuffix.end()));
-  if (DebugLogStateMerge) {
-    llvm::errs() << "\tconstraint prefix: [";
-    for (std::set<ref<Expr> >::iterator it = commonConstraints.begin(),
-                                        ie = commonConstraints.end();
-         it != ie; ++it)
-      llvm::errs() << *it << ", ";
-    llvm::errs() << "]\n";
-    llvm::errs() << "\tA suffix: [";
-    for (std::set<ref<Expr> >::iterator it = aSuffix.begin(),
-                                        ie = aSuffix.end();
-         it != ie; ++it)
-      llvm::errs() << *it << ", ";
-    llvm::errs() << "]\n";
-    llvm::errs() << "\tB suffix: [";
-    for (std::set<ref<Expr> >::iterator it = bSuffix.begin(),
-                                        ie = bSuffix.end();
-         it != ie; ++it)
-      llvm::errs() << *it << ", ";
-    llvm::errs() << "]\n";
-  }
-
   // We cannot merge if addresses would resolve differently in the
-  // states. This means:
+  // states (checked before the more expensive split of the constraints).
+  // This means:
   // 
   // 1. Any objects created since the branch in either object must
   // have been free'd.
@@ -264,6 +305,40 @@ bool ExecutionState::merge(const ExecutionState &b) {
     return false;
   }
   
+  std::set< ref<Expr> > aConstraints(constraints.begin(), constraints.end());
+  std::set< ref<Expr> > bConstraints(b.constraints.begin(), 
+                                     b.constraints.end());
+  std::set< ref<Expr> > commonConstraints, aSuffix, bSuffix;
+  std::set_intersection(aConstraints.begin(), aConstraints.end(),
+                        bConstraints.begin(), bConstraints.end(),
+                        std::inserter(commonConstraints, commonConstraints.begin()));
+  std::set_difference(aConstraints.begin(), aConstraints.end(),
+                      commonConstraints.begin(), commonConstraints.end(),
+                      std::inserter(aSuffix, aSuffix.end()));
+  std::set_difference(bConstraints.begin(), bConstraints.end(),
+                      commonConstraints.begin(), commonConstraints.end(),
+                      std::inserter(bSuffix, bSuffix.end()));
+  if (DebugLogStateMerge) {
+    llvm::errs() << "\tconstraint prefix: [";
+    for (std::set<ref<Expr> >::iterator it = commonConstraints.begin(),
+                                        ie = commonConstraints.end();
+         it != ie; ++it)
+      llvm::errs() << *it << ", ";
+    llvm::errs() << "]\n";
+    llvm::errs() << "\tA suffix: [";
+    for (std::set<ref<Expr> >::iterator it = aSuffix.begin(),
+                                        ie = aSuffix.end();
+         it != ie; ++it)
+      llvm::errs() << *it << ", ";
+    llvm::errs() << "]\n";
+    llvm::errs() << "\tB suffix: [";
+    for (std::set<ref<Expr> >::iterator it = bSuffix.begin(),
+                                        ie = bSuffix.end();
+         it != ie; ++it)
+      llvm::errs() << *it << ", ";
+    llvm::errs() << "]\n";
+  }
+
   // merge stack
 
   ref<Expr> inA = ConstantExpr::alloc(1, Expr::Bool);
@@ -294,6 +369,8 @@ bool ExecutionState::merge(const ExecutionState &b) {
         av = SelectExpr::create(inA, av, bv);
       }
     }
+    af.invalidateFingerprintContributions();
+    af.validCallersFingerprint = false;
   }
 
   for (std::set<const MemoryObject*>::iterator it = mutated.begin(), 
@@ -305,14 +382,41 @@ bool ExecutionState::merge(const ExecutionState &b) {
            "objects mutated but not writable in merging state");
     assert(otherOS);
 
+    std::vector<std::pair<unsigned, unsigned>> ranges;
+    getDifferingRanges(*os, *otherOS, ranges);
+    if (ranges.empty()) {
+      if (DebugLogStateMerge)
+        llvm::errs() << "\t\tidentical: " << mo->id << "\n";
+      continue;
+    }
+
+    // keep the fingerprint of the memory state up to date by rehashing only
+    // the merged bytes
+    std::vector<std::pair<unsigned, unsigned>> registrationRanges =
+        getRegistrationRanges(*os, ranges);
+    for (const auto &range : registrationRanges)
+      memoryState.unregisterWrite(getRangeAddress(mo, range.first), *mo, *os,
+                                  range.second - range.first);
+
     ObjectState *wos = addressSpace.getWriteable(mo, os);
-    for (unsigned i=0; i<mo->size; i++) {
-      ref<Expr> av = wos->read8(i);
-      ref<Expr> bv = otherOS->read8(i);
-      wos->write(i, SelectExpr::create(inA, av, bv));
+    for (const auto &range : ranges) {
+      if (DebugLogStateMerge)
+        llvm::errs() << "\t\tmerging " << mo->id << ": [+" << range.first
+                     << ", +" << range.second << ")\n";
+      for (unsigned i = range.first; i < range.second; i++) {
+        ref<Expr> av = wos->read8(i);
+        ref<Expr> bv = otherOS->read8(i);
+        wos->write(i, SelectExpr::create(inA, av, bv));
+      }
     }
+    for (const auto &range : registrationRanges)
+      memoryState.registerWrite(getRangeAddress(mo, range.first), *mo, *wos,
+                                range.second - range.first);
   }
 
+  // the merged state has not been on the path of this state
+  memoryState.registerMerge();
+
   constraints = ConstraintSet();
 
   ConstraintManager m(constraints);
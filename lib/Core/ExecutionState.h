@@ -61,9 +61,33 @@ struct StackFrame {
   // of intrinsic lowering.
   MemoryObject *varargs;
 
+  // Contributions of locals (indexed by register) to the fingerprints of the
+  // basic blocks they are live in, see MemoryState::registerBasicBlock().
+  // They are computed lazily, invalidated whenever a new value is bound to the
+  // corresponding register and not copied along with the stack frame.
+  mutable std::vector<MemoryFingerprint::fingerprint_t>
+      fingerprintContributions;
+  mutable std::vector<bool> validFingerprintContributions;
+
+  // Fingerprint of the locals of all calling stack frames, see
+  // MemoryState::getStateFingerprint(). It is computed lazily and remains
+  // valid as long as this stack frame exists, as only the locals of the top
+  // most stack frame can change.
+  mutable MemoryFingerprint::fingerprint_t callersFingerprint = {};
+  mutable bool validCallersFingerprint = false;
+
   StackFrame(KInstIterator caller, KFunction *kf);
   StackFrame(const StackFrame &s);
   ~StackFrame();
+
+  void invalidateFingerprintContribution(unsigned reg) {
+    if (reg < validFingerprintContributions.size())
+      validFingerprintContributions[reg] = false;
+  }
+
+  void invalidateFingerprintContributions() {
+    validFingerprintContributions.clear();
+  }
 };
 
 /// Contains information related to unwinding (Itanium ABI/2-Phase unwinding)
@@ -173,6 +197,10 @@ public:
   /// (i.e. to select the right phi values)
   std::uint32_t incomingBBIndex;
 
+  /// @brief Id of the Basic Block control flow arrived from (see
+  /// KFunction::basicBlocks)
+  std::uint32_t incomingBBId = 0;
+
   // Overall state of the state - Data specific
 
   /// @brief Exploration depth, i.e., number of times KLEE branched for this state
@@ -239,6 +267,14 @@ public:
   /// @brief Disables forking for this state. Set by user code
   bool forkDisabled;
 
+  /// @brief Whether this state is to be deprioritized, as it reached a loop
+  /// header in the same configuration as another state before
+  /// (-infinite-loop-detection-duplicate-states=deprioritize) or exceeded
+  /// the iteration budget of a loop
+  /// (-infinite-loop-detection-suspected-loops=deprioritize). Reset by the
+  /// searcher.
+  bool deprioritize = false;
+
 public:
   #ifdef KLEE_UNITTEST
   // provide this function only in the context of unittests
@@ -292,6 +292,8 @@ cl::list<Executor::TerminateReason> ExitOnErrorType(
         clEnumValN(Executor::ReadOnly, "ReadOnly", "Write to read-only memory"),
         clEnumValN(Executor::ReportError, "ReportError",
                    "klee_report_error called"),
+        clEnumValN(Executor::SuspectedInfiniteLoop, "SuspectedInfiniteLoop",
+                   "Loop iteration budget exceeded"),
         clEnumValN(Executor::User, "User", "Wrong klee_* functions invocation"),
         clEnumValN(Executor::UncaughtException, "UncaughtException",
                    "Exception was not caught"),
@@ -446,6 +448,7 @@ const char *Executor::TerminateReasonNames[] = {
   [ Ptr ] = "ptr",
   [ ReadOnly ] = "readonly",
   [ ReportError ] = "reporterror",
+  [ SuspectedInfiniteLoop ] = "suspected_infty",
   [ User ] = "user",
   [ UncaughtException ] = "uncaught_exception",
   [ UnexpectedException ] = "unexpected_exception",
@@ -539,6 +542,8 @@ Executor::Executor(LLVMContext &ctx, const InterpreterOptions &opts,
                         << sizeof(llvm::Function *) << ",\n";
       (*statesJSONFile) << "    \"trace_entry_size\": "
                         << MemoryState::getTraceStructSizes().first << ",\n";
+      (*statesJSONFile) << "    \"trace_index_node_size\": "
+                        << MemoryState::getTraceIndexNodeSize() << ",\n";
       (*statesJSONFile) << "    \"frames_entry_size\": "
                         << MemoryState::getTraceStructSizes().second << ",\n";
       (*statesJSONFile) << "    \"memory_state_size\": "
@@ -842,6 +847,8 @@ void Executor::allocateGlobalObjects(ExecutionState &state) {
                                         /*alignment=*/globalObjectAlignment);
     if (!mo)
       klee_error("out of memory");
+    if (kmodule->excludedGlobals.count(&v))
+      mo->isExcludedFromFingerprint = true;
     globalObjects.emplace(&v, mo);
     globalAddresses.emplace(&v, mo->getBaseExpr());
   }
@@ -1320,6 +1327,7 @@ const Cell& Executor::eval(KInstruction *ki, unsigned index,
 void Executor::bindLocal(KInstruction *target, ExecutionState &state, 
                          ref<Expr> value) {
   getDestCell(state, target).value = value;
+  state.stack.back().invalidateFingerprintContribution(target->dest);
 }
 
 void Executor::bindArgument(KFunction *kf, unsigned index, 
@@ -1327,6 +1335,8 @@ void Executor::bindArgument(KFunction *kf, unsigned index,
   assert(getArgumentCell(state, kf, index).value.isNull() &&
          "argument has previouly been set!");
   getArgumentCell(state, kf, index).value = value;
+  state.stack.back().invalidateFingerprintContribution(
+      kf->getArgRegister(index));
 }
 
 ref<Expr> Executor::toUnique(const ExecutionState &state, 
@@ -1638,7 +1648,8 @@ void Executor::unwindToNextLandingpad(ExecutionState &state) {
   for (std::size_t i = startIndex; i > lowestStackIndex; i--) {
     auto const &sf = state.stack.at(i);
 
-    Instruction *inst = sf.caller ? sf.caller->inst : nullptr;
+    KInstruction *kcaller = sf.caller;
+    Instruction *inst = kcaller ? kcaller->inst : nullptr;
 
     if (popFrames) {
       state.popFrame();
@@ -1698,7 +1709,7 @@ void Executor::unwindToNextLandingpad(ExecutionState &state) {
       } else {
         // in the cleanup phase, redirect control flow
         transferToBasicBlock(invoke->getUnwindDest(), invoke->getParent(),
-                             state);
+                             kcaller->basicBlockId, state);
       }
 
       // we are done, stop search/unwinding here
@@ -1743,8 +1754,14 @@ ref<klee::ConstantExpr> Executor::getEhTypeidFor(ref<Expr> type_info) {
 void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
                            std::vector<ref<Expr>> &arguments) {
 
+  // nullptr for declarations
+  KFunction *kf = nullptr;
+  if (f && !f->isDeclaration())
+    kf = kmodule->functionMap[f];
+
   if (DetectInfiniteLoops) {
-    state.memoryState.registerFunctionCall(f, state.stack.size() + 1, arguments);
+    state.memoryState.registerFunctionCall(f, kf, state.stack.size() + 1,
+                                           arguments);
   }
 
   Instruction *i = ki->inst;
@@ -1868,7 +1885,8 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
     if (InvokeInst *ii = dyn_cast<InvokeInst>(i)) {
       if (f->getName() != std::string("__cxa_throw") &&
           f->getName() != std::string("__cxa_rethrow")) {
-        transferToBasicBlock(ii->getNormalDest(), i->getParent(), state);
+        transferToBasicBlock(ii->getNormalDest(), i->getParent(),
+                             ki->basicBlockId, state);
       }
     }
   } else {
@@ -1884,7 +1902,6 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
     // guess. This just done to avoid having to pass KInstIterator everywhere
     // instead of the actual instruction, since we can't make a KInstIterator
     // from just an instruction (unlike LLVM).
-    KFunction *kf = kmodule->functionMap[f];
     KFunction *leavingFunction = state.stack.back().kf;
     state.pushFrame(state.prevPC, kf);
     state.pc = kf->instructions;
@@ -2045,15 +2062,22 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
       bindArgument(kf, k, state, arguments[k]);
 
     if (DetectInfiniteLoops) {
-      state.memoryState.registerBasicBlock(*state.pc->inst->getParent());
+      // entry block of the called function
+      state.memoryState.registerBasicBlock(kf, 0);
       if (state.memoryState.findInfiniteRecursion()) {
-        terminateStateOnError(state, "infinite loop", InfiniteLoop);
+        std::string info;
+        llvm::raw_string_ostream os(info);
+        os << "Period: " << state.memoryState.getInfiniteRecursionPeriod()
+           << " stack frames\n";
+        terminateStateOnError(state, "infinite loop", InfiniteLoop, nullptr,
+                              os.str());
       }
     }
   }
 }
 
-void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src, 
+void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src,
+                                    unsigned srcId,
                                     ExecutionState &state) {
   // Note that in general phi nodes can reuse phi values from the same
   // block but the incoming value is the eval() result *before* the
@@ -2074,20 +2098,80 @@ void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src,
   if (state.pc->inst->getOpcode() == Instruction::PHI) {
     PHINode *first = static_cast<PHINode*>(state.pc->inst);
     state.incomingBBIndex = first->getBasicBlockIndex(src);
+    state.incomingBBId = srcId;
   } else {
-    phiNodeProcessingCompleted(dst, src, state);
+    phiNodeProcessingCompleted(dst, src, srcId, state);
   }
 }
 
 void Executor::phiNodeProcessingCompleted(BasicBlock *dst, BasicBlock *src,
+                                          unsigned srcId,
                                           ExecutionState &state) {
   if (DetectInfiniteLoops) {
-    if ((dst->getSinglePredecessor() == nullptr) ||
-        InfiniteLoopDetectionDisableTwoPredecessorOpt) {
+    // (state.pc is the first non-PHI instruction of dst)
+    KFunction *kf = state.stack.back().kf;
+    unsigned id = state.pc->basicBlockId;
+    if (InfiniteLoopDetectionTruncateLoops ||
+        InfiniteLoopDetectionMaxLoopIterations) {
+      state.memoryState.registerLoopTransition(kf, srcId, id);
+    }
+    bool registerBB;
+    if (InfiniteLoopDetectionLoopHeadersOnly) {
+      registerBB = kf->basicBlocks[id].isLoopHeader;
+    } else {
       // more than one predecessor
-      state.memoryState.registerBasicBlock(*dst);
+      registerBB = (dst->getSinglePredecessor() == nullptr) ||
+                   InfiniteLoopDetectionDisableTwoPredecessorOpt;
+    }
+    if (InfiniteLoopDetectionSkipFiniteLoops &&
+        kf->basicBlocks[id].isInFiniteLoop) {
+      // loop is known to terminate: suspend registration until it is left
+      registerBB = false;
+    }
+    if (registerBB) {
+      state.memoryState.registerBasicBlock(kf, id);
       if (state.memoryState.findInfiniteLoopInFunction()) {
-        terminateStateOnError(state, "infinite loop", InfiniteLoop);
+        std::string info;
+        llvm::raw_string_ostream os(info);
+        os << "Period: " << state.memoryState.getInfiniteLoopPeriod()
+           << " registered basic blocks\n";
+        terminateStateOnError(state, "infinite loop", InfiniteLoop, nullptr,
+                              os.str());
+        return;
+      }
+    }
+    if (InfiniteLoopDetectionMaxLoopIterations &&
+        kf->basicBlocks[id].isLoopHeader &&
+        state.memoryState.registerLoopIteration(id) ==
+            InfiniteLoopDetectionMaxLoopIterations + 1ull) {
+      // no repetition has been found (yet), but the loop might not terminate
+      ++stats::suspectedLoops;
+      std::string info;
+      llvm::raw_string_ostream os(info);
+      os << "Iterations: " << InfiniteLoopDetectionMaxLoopIterations << "\n";
+      if (InfiniteLoopDetectionSuspectedLoops == SUSPECTED_TERMINATE) {
+        terminateStateOnError(state, "suspected infinite loop",
+                              SuspectedInfiniteLoop, nullptr, os.str());
+        return;
+      }
+      reportError(state, "suspected infinite loop", SuspectedInfiniteLoop,
+                  nullptr, os.str());
+      if (shouldExitOn(SuspectedInfiniteLoop))
+        haltExecution = true;
+      state.deprioritize = true;
+    }
+    if (InfiniteLoopDetectionDuplicateStates != DUPLICATES_KEEP &&
+        kf->basicBlocks[id].isLoopHeader) {
+      MemoryFingerprint::fingerprint_t fingerprint;
+      if (state.memoryState.getStateFingerprint(kf, id, fingerprint) &&
+          stateFingerprints.insert(fingerprint, state)) {
+        ++stats::duplicateStates;
+        if (InfiniteLoopDetectionDuplicateStates == DUPLICATES_TERMINATE) {
+          // another state explores the same continuation
+          terminateState(state);
+        } else {
+          state.deprioritize = true;
+        }
       }
     }
   }
@@ -2163,7 +2247,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
         statsTracker->framePopped(state);
 
       if (InvokeInst *ii = dyn_cast<InvokeInst>(caller)) {
-        transferToBasicBlock(ii->getNormalDest(), caller->getParent(), state);
+        transferToBasicBlock(ii->getNormalDest(), caller->getParent(),
+                             kcaller->basicBlockId, state);
       } else {
         state.pc = kcaller;
         ++state.pc;
@@ -2248,7 +2333,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::Br: {
     BranchInst *bi = cast<BranchInst>(i);
     if (bi->isUnconditional()) {
-      transferToBasicBlock(bi->getSuccessor(0), bi->getParent(), state);
+      transferToBasicBlock(bi->getSuccessor(0), bi->getParent(),
+                           ki->basicBlockId, state);
     } else {
       // FIXME: Find a way that we don't have this hidden dependency.
       assert(bi->getCondition() == bi->getOperand(0) &&
@@ -2266,9 +2352,11 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
         statsTracker->markBranchVisited(branches.first, branches.second);
 
       if (branches.first)
-        transferToBasicBlock(bi->getSuccessor(0), bi->getParent(), *branches.first);
+        transferToBasicBlock(bi->getSuccessor(0), bi->getParent(),
+                             ki->basicBlockId, *branches.first);
       if (branches.second)
-        transferToBasicBlock(bi->getSuccessor(1), bi->getParent(), *branches.second);
+        transferToBasicBlock(bi->getSuccessor(1), bi->getParent(),
+                             ki->basicBlockId, *branches.second);
     }
     break;
   }
@@ -2281,7 +2369,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     // concrete address
     if (const auto CE = dyn_cast<ConstantExpr>(address.get())) {
       const auto bb_address = (BasicBlock *) CE->getZExtValue(Context::get().getPointerWidth());
-      transferToBasicBlock(bb_address, bi->getParent(), state);
+      transferToBasicBlock(bb_address, bi->getParent(), ki->basicBlockId,
+                           state);
       break;
     }
 
@@ -2341,7 +2430,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     assert(targets.size() == branches.size());
     for (std::vector<ExecutionState *>::size_type k = 0; k < branches.size(); ++k) {
       if (branches[k]) {
-        transferToBasicBlock(targets[k], bi->getParent(), *branches[k]);
+        transferToBasicBlock(targets[k], bi->getParent(), ki->basicBlockId,
+                             *branches[k]);
       }
     }
 
@@ -2363,7 +2453,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 #else
       unsigned index = si->findCaseValue(ci).getSuccessorIndex();
 #endif
-      transferToBasicBlock(si->getSuccessor(index), si->getParent(), state);
+      transferToBasicBlock(si->getSuccessor(index), si->getParent(),
+                           ki->basicBlockId, state);
     } else {
       // Handle possible different branch targets
 
@@ -2463,7 +2554,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
            it != ie; ++it) {
         ExecutionState *es = *bit;
         if (es)
-          transferToBasicBlock(*it, bb, *es);
+          transferToBasicBlock(*it, bb, ki->basicBlockId, *es);
         ++bit;
       }
     }
@@ -2597,7 +2688,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     if (i->getNextNode()->getOpcode() != Instruction::PHI) {
       // no more PHI nodes coming
       BasicBlock *src = cast<PHINode>(i)->getIncomingBlock(state.incomingBBIndex);
-      phiNodeProcessingCompleted(i->getParent(), src, state);
+      phiNodeProcessingCompleted(i->getParent(), src, state.incomingBBId,
+                                 state);
     }
     break;
   }
@@ -3832,6 +3924,11 @@ void Executor::terminateState(ExecutionState &state) {
 
   interpreterHandler->incPathsExplored();
 
+  if (InfiniteLoopDetectionDuplicateStates != DUPLICATES_KEEP) {
+    // entries refer to the constraints of the state
+    stateFingerprints.remove(state);
+  }
+
   std::vector<ExecutionState *>::iterator it =
       std::find(addedStates.begin(), addedStates.end(), &state);
   if (it==addedStates.end()) {
@@ -3926,11 +4023,11 @@ bool Executor::shouldExitOn(enum TerminateReason termReason) {
   return false;
 }
 
-void Executor::terminateStateOnError(ExecutionState &state,
-                                     const llvm::Twine &messaget,
-                                     enum TerminateReason termReason,
-                                     const char *suffix,
-                                     const llvm::Twine &info) {
+std::string Executor::reportError(ExecutionState &state,
+                                  const llvm::Twine &messaget,
+                                  enum TerminateReason termReason,
+                                  const char *suffix,
+                                  const llvm::Twine &info) {
   auto timeToError = std::chrono::steady_clock::now() - executorStartTime;
 
   std::string message = messaget.str();
@@ -3988,6 +4085,16 @@ void Executor::terminateStateOnError(ExecutionState &state,
                                                 suffix);
   }
 
+  return ktest;
+}
+
+void Executor::terminateStateOnError(ExecutionState &state,
+                                     const llvm::Twine &messaget,
+                                     enum TerminateReason termReason,
+                                     const char *suffix,
+                                     const llvm::Twine &info) {
+  std::string ktest = reportError(state, messaget, termReason, suffix, info);
+
   updateStatesJSON(nullptr, state, ktest, TerminateReasonNames[termReason]);
   terminateState(state);
 
@@ -4014,10 +4121,6 @@ void Executor::callExternalFunction(ExecutionState &state,
   if (specialFunctionHandler->handle(state, function, target, arguments))
     return;
 
-  if (DetectInfiniteLoops) {
-    state.memoryState.registerExternalFunctionCall();
-  }
-
   if (ExternalCalls == ExternalCallPolicy::None &&
       !okExternals.count(function->getName().str())) {
     klee_warning("Disallowed call to external function: %s\n",
@@ -4033,6 +4136,8 @@ void Executor::callExternalFunction(ExecutionState &state,
   uint64_t *args = (uint64_t*) alloca(2*sizeof(*args) * (arguments.size() + 1));
   memset(args, 0, 2 * sizeof(*args) * (arguments.size() + 1));
   unsigned wordIndex = 2;
+  // objects pointed to by arguments, which the function might modify
+  std::vector<const MemoryObject *> pointerArguments;
   for (std::vector<ref<Expr> >::iterator ai = arguments.begin(), 
        ae = arguments.end(); ai!=ae; ++ai) {
     if (ExternalCalls == ExternalCallPolicy::All) { // don't bother checking uniqueness
@@ -4048,6 +4153,8 @@ void Executor::callExternalFunction(ExecutionState &state,
       if (ce->getWidth() == Context::get().getPointerWidth() &&
           state.addressSpace.resolveOne(ce, op)) {
         op.second->flushToConcreteStore(solver, state);
+        if (DetectInfiniteLoops)
+          pointerArguments.push_back(op.first);
       }
       wordIndex += (ce->getWidth()+63)/64;
     } else {
@@ -4056,6 +4163,12 @@ void Executor::callExternalFunction(ExecutionState &state,
         // XXX kick toMemory functions from here
         ce->toMemory(&args[wordIndex]);
         wordIndex += (ce->getWidth()+63)/64;
+        ObjectPair op;
+        if (DetectInfiniteLoops &&
+            ce->getWidth() == Context::get().getPointerWidth() &&
+            state.addressSpace.resolveOne(ce, op)) {
+          pointerArguments.push_back(op.first);
+        }
       } else {
         terminateStateOnExecError(state, 
                                   "external call with symbolic argument: " + 
@@ -4106,6 +4219,18 @@ void Executor::callExternalFunction(ExecutionState &state,
       klee_warning_once(function, "%s", os.str().c_str());
   }
 
+  // objects modified by the call are rehashed, the memory trace is only
+  // cleared if the effects of the function are unknown
+  ConcreteChangeCallback onChange;
+  if (DetectInfiniteLoops) {
+    state.memoryState.registerExternalFunctionCall(function,
+                                                   std::move(pointerArguments));
+    onChange = [&state](const MemoryObject *mo, const ObjectState *os,
+                        bool modified) {
+      state.memoryState.registerExternalWrite(*mo, *os, modified);
+    };
+  }
+
   bool success = externalDispatcher->executeCall(function, target->inst, args);
   if (!success) {
     terminateStateOnError(state, "failed external call: " + function->getName(),
@@ -4113,7 +4238,7 @@ void Executor::callExternalFunction(ExecutionState &state,
     return;
   }
 
-  if (!state.addressSpace.copyInConcretes()) {
+  if (!state.addressSpace.copyInConcretes(onChange)) {
     terminateStateOnError(state, "external modified read-only object",
                           External);
     return;
@@ -4122,8 +4247,16 @@ void Executor::callExternalFunction(ExecutionState &state,
 #ifndef WINDOWS
   // Update errno memory object with the errno value from the call
   int error = externalDispatcher->getLastErrno();
+  // errno may be set by any external function
+  ConcreteChangeCallback onErrnoChange;
+  if (DetectInfiniteLoops) {
+    onErrnoChange = [&state](const MemoryObject *mo, const ObjectState *os,
+                             bool modified) {
+      state.memoryState.registerExternalWrite(*mo, *os, modified, true);
+    };
+  }
   state.addressSpace.copyInConcrete(result.first, result.second,
-                                    (uint64_t)&error);
+                                    (uint64_t)&error, onErrnoChange);
 #endif
 
   // there is no new stack frame for external functions and thus no return
@@ -4227,7 +4360,7 @@ void Executor::executeAlloc(ExecutionState &state,
         const MemoryObject *reallocatedObject = reallocFrom->getObject();
 
         if (DetectInfiniteLoops) {
-          state.memoryState.unregisterWrite(*reallocatedObject, *reallocFrom);
+          state.memoryState.registerFree(*reallocatedObject, *reallocFrom);
         }
 
         state.addressSpace.unbindObject(reallocatedObject);
@@ -4346,7 +4479,7 @@ void Executor::executeFree(ExecutionState &state,
         terminateStateOnError(*it->second, "free of global", Free, NULL,
                               getAddressInfo(*it->second, address));
       } else {
-        it->second->memoryState.unregisterWrite(*mo, *os);
+        it->second->memoryState.registerFree(*mo, *os);
         it->second->addressSpace.unbindObject(mo);
         if (target)
           bindLocal(target, *it->second, Expr::createPointer(0));
@@ -4444,6 +4577,7 @@ void Executor::executeMemoryOperation(ExecutionState &state,
         } else {
           ObjectState *wos = state.addressSpace.getWriteable(mo, os);
           if (DetectInfiniteLoops) {
+            boundSymbolicWrite(state, *mo, offset, bytes);
             // unregister previous value to avoid cancellation
             state.memoryState.unregisterWrite(address, *mo, *wos, bytes);
           }
@@ -4495,6 +4629,7 @@ void Executor::executeMemoryOperation(ExecutionState &state,
         } else {
           ObjectState *wos = bound->addressSpace.getWriteable(mo, os);
           if (DetectInfiniteLoops) {
+            boundSymbolicWrite(*bound, *mo, mo->getOffsetExpr(address), bytes);
             // unregister previous value to avoid cancellation
             bound->memoryState.unregisterWrite(address, *mo, *wos, bytes);
           }
@@ -4525,6 +4660,69 @@ void Executor::executeMemoryOperation(ExecutionState &state,
   }
 }
 
+void Executor::boundSymbolicWrite(ExecutionState &state,
+                                  const MemoryObject &mo, ref<Expr> offset,
+                                  unsigned bytes) {
+  if (isa<ConstantExpr>(offset) || !InfiniteLoopDetectionSymbolicWriteRange ||
+      mo.size <= InfiniteLoopDetectionSymbolicWriteRange) {
+    // rehashing the whole object is cheaper than querying the solver
+    return;
+  }
+
+  if (state.memoryState.hasSymbolicWriteRange(offset)) {
+    // range was computed by a previous execution of the same instruction
+    // (possibly in an ancestor state) and is still valid
+    return;
+  }
+
+  // Binary search for the bounds of the feasible offsets (as
+  // Solver::getRange(), which asserts on solver failures). The write is in
+  // bounds, so the upper bound is within the object. If any query fails, the
+  // whole object is rehashed.
+  Expr::Width width = offset->getWidth();
+  bool success = true;
+  bool result;
+  auto mustBeTrue = [&](ref<Expr> condition) {
+    success = success && solver->mustBeTrue(state.constraints, condition,
+                                            result, state.queryMetaData);
+    return success && result;
+  };
+
+  solver->setTimeout(coreSolverTimeout);
+  ref<ConstantExpr> value;
+  success = solver->getValue(state.constraints, offset, value,
+                             state.queryMetaData);
+  std::uint64_t example = success ? value->getZExtValue() : 0;
+
+  // largest lower bound
+  std::uint64_t lo = 0;
+  std::uint64_t hi = example;
+  while (success && lo < hi) {
+    std::uint64_t mid = lo + (hi - lo + 1) / 2;
+    if (mustBeTrue(UgeExpr::create(offset, ConstantExpr::create(mid, width))))
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  std::uint64_t begin = lo;
+
+  // smallest upper bound
+  lo = example;
+  hi = std::max<std::uint64_t>(example, mo.size - 1);
+  while (success && lo < hi) {
+    std::uint64_t mid = lo + (hi - lo) / 2;
+    if (mustBeTrue(UleExpr::create(offset, ConstantExpr::create(mid, width))))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  std::uint64_t end = lo;
+  solver->setTimeout(time::Span());
+
+  if (success)
+    state.memoryState.setSymbolicWriteRange(offset, begin, end + bytes);
+}
+
 void Executor::executeMakeSymbolic(ExecutionState &state,
                                    ref<Expr> address,
                                    const MemoryObject *mo,
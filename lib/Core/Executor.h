@@ -16,6 +16,7 @@
 #define KLEE_EXECUTOR_H
 
 #include "ExecutionState.h"
+#include "StateFingerprintTable.h"
 #include "UserSearcher.h"
 
 #include "klee/ADT/RNG.h"
@@ -111,6 +112,7 @@ public:
     Ptr,
     ReadOnly,
     ReportError,
+    SuspectedInfiniteLoop,
     User,
     UncaughtException,
     UnexpectedException,
@@ -233,6 +235,10 @@ private:
   /// JSON file to print state info to
   std::unique_ptr<llvm::raw_ostream> statesJSONFile;
 
+  /// Configurations in which states reached loop headers, see
+  /// -infinite-loop-detection-duplicate-states
+  StateFingerprintTable stateFingerprints;
+
   /// Typeids used during exception handling
   std::vector<ref<Expr>> eh_typeids;
 
@@ -268,11 +274,14 @@ private:
 
   void stepInstruction(ExecutionState &state);
   void updateStates(ExecutionState *current);
+  /// srcId: id of src in the current KFunction
   void transferToBasicBlock(llvm::BasicBlock *dst, 
 			    llvm::BasicBlock *src,
+			    unsigned srcId,
 			    ExecutionState &state);
   void phiNodeProcessingCompleted(llvm::BasicBlock *dst,
                 llvm::BasicBlock *src,
+                unsigned srcId,
                 ExecutionState &state);
 
   void callExternalFunction(ExecutionState &state,
@@ -357,6 +366,11 @@ private:
                               ref<Expr> value /* undef if read */,
                               KInstruction *target /* undef if write */);
 
+  // bound the bytes of mo that are rehashed by the MemoryState for an
+  // in-bounds write with a symbolic offset
+  void boundSymbolicWrite(ExecutionState &state, const MemoryObject &mo,
+                          ref<Expr> offset, unsigned bytes);
+
   void executeMakeSymbolic(ExecutionState &state,
                            ref<Expr> address,
                            const MemoryObject *mo,
@@ -454,6 +468,12 @@ private:
   void terminateStateEarly(ExecutionState &state, const llvm::Twine &message);
   // call exit handler and terminate state
   void terminateStateOnExit(ExecutionState &state);
+  // call error handler (once per error location unless -emit-all-errors)
+  // and return the path of the generated test case
+  std::string reportError(ExecutionState &state, const llvm::Twine &message,
+                          enum TerminateReason termReason,
+                          const char *suffix = NULL,
+                          const llvm::Twine &longMessage = "");
   // call error handler and terminate state
   void terminateStateOnError(ExecutionState &state, const llvm::Twine &message,
                              enum TerminateReason termReason,
@@ -34,6 +34,201 @@ llvm::cl::opt<bool> InfiniteLoopDetectionDisableTwoPredecessorOpt(
                    "two predecessors (default=false)"),
     llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
 
+llvm::cl::opt<bool> InfiniteLoopDetectionLoopHeadersOnly(
+    "infinite-loop-detection-loop-headers-only",
+    llvm::cl::desc("Only register and search for loops on basic blocks "
+                   "through which a loop is entered (headers of natural "
+                   "loops and entry points of irreducible cycles) instead of "
+                   "all basic blocks with at least two predecessors. The "
+                   "check for infinite recursion on function entry is not "
+                   "affected (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionSkipFiniteLoops(
+    "infinite-loop-detection-skip-finite-loops",
+    llvm::cl::desc("Do not register basic blocks whose innermost loop has a "
+                   "trip count that can be bounded by LLVM's "
+                   "ScalarEvolution. Memory writes within these loops still "
+                   "update the fingerprint (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionTruncateLoops(
+    "infinite-loop-detection-truncate-loops",
+    llvm::cl::desc("Remove all entries that have been registered within a "
+                   "loop from the memory trace as soon as execution leaves "
+                   "the loop. Has no effect with "
+                   "-infinite-loop-detection-algorithm=brent (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionIgnoreWriteOnlyGlobals(
+    "infinite-loop-detection-ignore-write-only-globals",
+    llvm::cl::desc("Exclude global variables whose value never influences the "
+                   "execution (e.g. statistics counters that are only "
+                   "incremented) and registers that hold their values from "
+                   "the fingerprint (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<std::string> InfiniteLoopDetectionFunctionLists(
+    "infinite-loop-detection-function-lists",
+    llvm::cl::desc("JSON or YAML file with additional input, output, "
+                   "library, memory, pure and argmem functions (see README) "
+                   "(default=none)"),
+    llvm::cl::value_desc("file"), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<InfiniteLoopDetectionDuplicateStatesType>
+    InfiniteLoopDetectionDuplicateStates(
+        "infinite-loop-detection-duplicate-states",
+        llvm::cl::desc("What to do with a state that reaches a loop header "
+                       "with the same call stack, fingerprint and constraints "
+                       "as another state before (default=keep)"),
+        llvm::cl::values(
+            clEnumValN(DUPLICATES_KEEP, "keep", "Explore it as usual"),
+            clEnumValN(DUPLICATES_TERMINATE, "terminate",
+                       "Terminate it without generating a test case"),
+            clEnumValN(DUPLICATES_DEPRIORITIZE, "deprioritize",
+                       "Only explore it once no other states are left")
+                KLEE_LLVM_CL_VAL_END),
+        llvm::cl::init(DUPLICATES_KEEP), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<unsigned> InfiniteLoopDetectionMaxLoopIterations(
+    "infinite-loop-detection-max-loop-iterations",
+    llvm::cl::desc("Number of iterations of a loop after which a state is "
+                   "suspected not to terminate, counted per loop header and "
+                   "stack frame until the loop is left or an input function "
+                   "is called (0=unlimited) (default=0)"),
+    llvm::cl::init(0), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<InfiniteLoopDetectionSuspectedLoopsType>
+    InfiniteLoopDetectionSuspectedLoops(
+        "infinite-loop-detection-suspected-loops",
+        llvm::cl::desc("What to do with a state after generating a test case "
+                       "for exceeding "
+                       "-infinite-loop-detection-max-loop-iterations "
+                       "(default=terminate)"),
+        llvm::cl::values(
+            clEnumValN(SUSPECTED_TERMINATE, "terminate", "Terminate it"),
+            clEnumValN(SUSPECTED_DEPRIORITIZE, "deprioritize",
+                       "Only explore it further once no other states are "
+                       "left")
+                KLEE_LLVM_CL_VAL_END),
+        llvm::cl::init(SUSPECTED_TERMINATE), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<InfiniteLoopDetectionAlgorithmType>
+    InfiniteLoopDetectionAlgorithm(
+        "infinite-loop-detection-algorithm",
+        llvm::cl::desc("Algorithm used to find repetitions of (instruction, "
+                       "fingerprint) pairs (default=trace)"),
+        llvm::cl::values(
+            clEnumValN(DETECT_WITH_TRACE, "trace",
+                       "Store every pair in a memory trace, detects every "
+                       "infinite loop on its first repetition"),
+            clEnumValN(DETECT_WITH_BRENT, "brent",
+                       "Only store a checkpoint per stack frame (Brent's "
+                       "algorithm), needs constant memory per stack frame "
+                       "but detects infinite loops later")
+                KLEE_LLVM_CL_VAL_END),
+        llvm::cl::init(DETECT_WITH_TRACE), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionCompactTrace(
+    "infinite-loop-detection-compact-trace",
+    llvm::cl::desc("Store memory trace entries as pairs of 32-bit ids of "
+                   "globally interned instructions and fingerprints instead "
+                   "of storing fingerprints by value (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<unsigned> InfiniteLoopDetectionMaxFrameEntries(
+    "infinite-loop-detection-max-frame-entries",
+    llvm::cl::desc("Maximum number of memory trace entries per stack frame, "
+                   "older entries are evicted when it is reached, which may "
+                   "delay or prevent the detection of loops with a period of "
+                   "more than half of this number (0=unlimited) (default=0)"),
+    llvm::cl::init(0), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<InfiniteLoopDetectionEvictionType> InfiniteLoopDetectionEviction(
+    "infinite-loop-detection-eviction",
+    llvm::cl::desc("Entries retained on eviction in addition to the first and "
+                   "the newest ones (see "
+                   "-infinite-loop-detection-max-frame-entries) "
+                   "(default=sampling)"),
+    llvm::cl::values(
+        clEnumValN(EVICT_OLDEST, "oldest",
+                   "None, i.e. drop the oldest entries"),
+        clEnumValN(EVICT_SAMPLING, "sampling",
+                   "Up to (n/2 - 1)/2 entries at the largest offsets that "
+                   "are powers of two, such that loops with longer periods "
+                   "are still detected eventually")
+            KLEE_LLVM_CL_VAL_END),
+    llvm::cl::init(EVICT_SAMPLING), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<InfiniteLoopDetectionWriteHashingType>
+    InfiniteLoopDetectionWriteHashing(
+        "infinite-loop-detection-write-hashing",
+        llvm::cl::desc("Granularity at which memory writes are added to the "
+                       "fingerprint (default=byte)"),
+        llvm::cl::values(
+            clEnumValN(HASH_WRITES_PER_BYTE, "byte",
+                       "Hash every written byte separately"),
+            clEnumValN(HASH_WRITES_PER_CHUNK, "chunk",
+                       "Hash written bytes together in fixed-size chunks "
+                       "(see -infinite-loop-detection-chunk-size)")
+                KLEE_LLVM_CL_VAL_END),
+        llvm::cl::init(HASH_WRITES_PER_BYTE), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<unsigned> InfiniteLoopDetectionChunkSize(
+    "infinite-loop-detection-chunk-size",
+    llvm::cl::desc("Number of bytes of a memory object that are hashed "
+                   "together if -infinite-loop-detection-write-hashing=chunk "
+                   "(default=64)"),
+    llvm::cl::init(64), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionCacheObjectContributions(
+    "infinite-loop-detection-cache-object-contributions",
+    llvm::cl::desc("Store the fingerprint contribution of each chunk with the "
+                   "memory object, so that unregistering the previous value "
+                   "on a write does not need to rehash it (only used if "
+                   "-infinite-loop-detection-write-hashing=chunk, needs more "
+                   "memory) (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionLazyWrites(
+    "infinite-loop-detection-lazy-writes",
+    llvm::cl::desc("Only remove the previous value of written bytes from the "
+                   "fingerprint immediately and add their new value when the "
+                   "fingerprint is needed next (e.g. when a basic block is "
+                   "registered), so that repeated writes to the same bytes "
+                   "are only hashed once (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<unsigned> InfiniteLoopDetectionSymbolicWriteRange(
+    "infinite-loop-detection-symbolic-write-range",
+    llvm::cl::desc("For writes with a symbolic offset to memory objects "
+                   "larger than this number of bytes, query the solver for "
+                   "the feasible offsets and only rehash the bytes that can "
+                   "be affected instead of the whole object (0=always "
+                   "rehash whole object) (default=0)"),
+    llvm::cl::init(0), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<InfiniteLoopDetectionFingerprintType>
+    InfiniteLoopDetectionFingerprint(
+        "infinite-loop-detection-fingerprint",
+        llvm::cl::desc("Hash function used to compute fingerprints "
+                       "(default=blake2b)"),
+        llvm::cl::values(
+            clEnumValN(FINGERPRINT_BLAKE2B, "blake2b",
+                       "256-bit BLAKE2b (cryptographic)"),
+            clEnumValN(FINGERPRINT_FAST128, "fast128",
+                       "128-bit multiply-mix hash (non-cryptographic, "
+                       "considerably faster)")
+                KLEE_LLVM_CL_VAL_END),
+        llvm::cl::init(FINGERPRINT_BLAKE2B), llvm::cl::cat(InfiniteLoopCat));
+
+llvm::cl::opt<bool> InfiniteLoopDetectionHashExprAsText(
+    "infinite-loop-detection-hash-expressions-as-text",
+    llvm::cl::desc("Add symbolic expressions to fingerprints by hashing their "
+                   "textual representation instead of their cached structural "
+                   "hash (slow, for debugging) (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(InfiniteLoopCat));
+
 llvm::cl::opt<bool> InfiniteLoopLogStateJSON(
     "infinite-loop-detection-log-state-json-files",
     llvm::cl::desc("Creates two files (states.json, states_fork.json) in "
@@ -19,6 +19,7 @@
 #include "klee/Support/OptionCategories.h"
 #include "klee/Solver/Solver.h"
 #include "klee/Support/ErrorHandling.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
 
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instruction.h"
@@ -26,6 +27,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
@@ -116,7 +118,9 @@ ObjectState::ObjectState(const ObjectState &os)
     knownSymbolics(0),
     updates(os.updates),
     size(os.size),
-    readOnly(false) {
+    readOnly(false),
+    fingerprintContributions(os.fingerprintContributions),
+    validFingerprintContributions(os.validFingerprintContributions) {
   assert(!os.readOnly && "no need to copy read only object?");
   if (os.knownSymbolics) {
     knownSymbolics = new ref<Expr>[size];
@@ -210,6 +214,7 @@ void ObjectState::flushToConcreteStore(TimingSolver *solver,
 }
 
 void ObjectState::makeConcrete() {
+  invalidateFingerprintContributions();
   delete concreteMask;
   delete flushMask;
   delete[] knownSymbolics;
@@ -222,6 +227,7 @@ void ObjectState::makeSymbolic() {
   assert(!updates.head &&
          "XXX makeSymbolic of objects with symbolic values is unsupported");
 
+  invalidateFingerprintContributions();
   // XXX simplify this, can just delete various arrays I guess
   for (unsigned i=0; i<size; i++) {
     markByteSymbolic(i);
@@ -371,6 +377,18 @@ ref<Expr> ObjectState::read8(unsigned offset) const {
   }    
 }
 
+const uint8_t *ObjectState::readConcreteRange(unsigned begin,
+                                              unsigned end) const {
+  assert(begin <= end && end <= size && "invalid range");
+  if (concreteMask) {
+    for (unsigned i = begin; i < end; i++) {
+      if (!concreteMask->get(i))
+        return nullptr;
+    }
+  }
+  return concreteStore + begin;
+}
+
 ref<Expr> ObjectState::read8(ref<Expr> offset) const {
   assert(!isa<ConstantExpr>(offset) && "constant offset passed to symbolic read8");
   unsigned base, size;
@@ -388,8 +406,17 @@ ref<Expr> ObjectState::read8(ref<Expr> offset) const {
   return ReadExpr::create(getUpdates(), ZExtExpr::create(offset, Expr::Int32));
 }
 
+void ObjectState::invalidateFingerprintContribution(unsigned offset) {
+  if (!validFingerprintContributions.empty()) {
+    unsigned chunkSize =
+        std::max(1u, InfiniteLoopDetectionChunkSize.getValue());
+    validFingerprintContributions[offset / chunkSize] = false;
+  }
+}
+
 void ObjectState::write8(unsigned offset, uint8_t value) {
   //assert(read_only == false && "writing to read-only object!");
+  invalidateFingerprintContribution(offset);
   concreteStore[offset] = value;
   setKnownSymbolic(offset, 0);
 
@@ -402,6 +429,7 @@ void ObjectState::write8(unsigned offset, ref<Expr> value) {
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(value)) {
     write8(offset, (uint8_t) CE->getZExtValue(8));
   } else {
+    invalidateFingerprintContribution(offset);
     setKnownSymbolic(offset, value.get());
       
     markByteSymbolic(offset);
@@ -414,6 +442,7 @@ void ObjectState::write8(ref<Expr> offset, ref<Expr> value) {
   unsigned base, size;
   fastRangeCheckOffset(offset, &base, &size);
   flushRangeForWrite(base, size);
+  invalidateFingerprintContributions();
 
   if (size>4096) {
     std::string allocInfo;
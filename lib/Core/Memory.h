@@ -11,6 +11,7 @@
 #define KLEE_MEMORY_H
 
 #include "Context.h"
+#include "MemoryFingerprint.h"
 #include "TimingSolver.h"
 
 #include "klee/Expr/Expr.h"
@@ -61,6 +62,12 @@ public:
 
   bool isUserSpecified;
 
+  /// Whether changes to this object are ignored by the infinite loop
+  /// detection in all states (write-only global with
+  /// -infinite-loop-detection-ignore-write-only-globals, see
+  /// MemoryState::excludeFromFingerprint() for single states).
+  bool isExcludedFromFingerprint = false;
+
   MemoryManager *parent;
 
   /// "Location" for which this memory object was allocated. This
@@ -206,6 +213,14 @@ public:
 
   bool readOnly;
 
+  // Fingerprint contributions of the chunks of this object as last
+  // registered by MemoryState::applyWriteFragment() (with
+  // -infinite-loop-detection-cache-object-contributions). They are copied
+  // along with the object and invalidated by every write.
+  mutable std::vector<MemoryFingerprint::fingerprint_t>
+      fingerprintContributions;
+  mutable std::vector<bool> validFingerprintContributions;
+
 public:
   /// Create a new object state for the given memory object with concrete
   /// contents. The initial contents are undefined, it is the callers
@@ -232,6 +247,10 @@ public:
   ref<Expr> read(unsigned offset, Expr::Width width) const;
   ref<Expr> read8(unsigned offset) const;
 
+  /// Concrete contents of the bytes [begin, end), or nullptr if any of them
+  /// is symbolic. Does not create expressions for the individual bytes.
+  const uint8_t *readConcreteRange(unsigned begin, unsigned end) const;
+
   // return bytes written.
   void write(unsigned offset, ref<Expr> value);
   void write(ref<Expr> offset, ref<Expr> value);
@@ -275,6 +294,11 @@ private:
   void markByteUnflushed(unsigned offset);
   void setKnownSymbolic(unsigned offset, Expr *value);
 
+  void invalidateFingerprintContribution(unsigned offset);
+  void invalidateFingerprintContributions() {
+    validFingerprintContributions.clear();
+  }
+
   ArrayCache *getArrayCache() const;
 };
   
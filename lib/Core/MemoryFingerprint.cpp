@@ -2,6 +2,7 @@
 
 #include "klee/Expr/ExprPPrinter.h"
 #include "klee/Module/KModule.h"
+#include "klee/Support/FastHash.h"
 
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/DebugLoc.h"
@@ -14,16 +15,27 @@ namespace klee {
 /* MemoryFingerprint_CryptoPP_BLAKE2b */
 
 void MemoryFingerprint_CryptoPP_BLAKE2b::updateUint8(const std::uint8_t value) {
-  static_assert(sizeof(CryptoPP::byte) == sizeof(std::uint8_t));
+  static_assert(sizeof(CryptoPP::byte) == sizeof(std::uint8_t),
+                "CryptoPP::byte must be a single byte");
   blake2b.Update(&value, 1);
 }
 
 void MemoryFingerprint_CryptoPP_BLAKE2b::updateUint64(const std::uint64_t value) {
-  static_assert(sizeof(CryptoPP::byte) == sizeof(std::uint8_t));
+  static_assert(sizeof(CryptoPP::byte) == sizeof(std::uint8_t),
+                "CryptoPP::byte must be a single byte");
   blake2b.Update(reinterpret_cast<const std::uint8_t*>(&value), 8);
 }
 
+void MemoryFingerprint_CryptoPP_BLAKE2b::updateBytes(const std::uint8_t *bytes,
+                                                     std::size_t size) {
+  blake2b.Update(bytes, size);
+}
+
 void MemoryFingerprint_CryptoPP_BLAKE2b::updateExpr(ref<Expr> expr) {
+  if (!InfiniteLoopDetectionHashExprAsText) {
+    updateExprContentHash(*expr);
+    return;
+  }
   MemoryFingerprint_ostream<CryptoPP::BLAKE2b> OS(blake2b);
   ExprPPrinter::printSingleExpr(OS, expr);
 }
@@ -47,6 +59,64 @@ void MemoryFingerprint_ostream<CryptoPP::BLAKE2b>::write_impl(const char *ptr,
 }
 
 
+/* MemoryFingerprint_Selectable */
+
+void MemoryFingerprint_Selectable::updateUint8(const std::uint8_t value) {
+  data.push_back(value);
+}
+
+void MemoryFingerprint_Selectable::updateUint64(const std::uint64_t value) {
+  const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t *>(&value);
+  data.append(bytes, bytes + sizeof(value));
+}
+
+void MemoryFingerprint_Selectable::updateBytes(const std::uint8_t *bytes,
+                                               std::size_t size) {
+  data.append(bytes, bytes + size);
+}
+
+void MemoryFingerprint_Selectable::updateExpr(ref<Expr> expr) {
+  if (!InfiniteLoopDetectionHashExprAsText) {
+    updateExprContentHash(*expr);
+    return;
+  }
+  MemoryFingerprint_ostream<llvm::SmallVectorImpl<std::uint8_t>> OS(data);
+  ExprPPrinter::printSingleExpr(OS, expr);
+}
+
+void MemoryFingerprint_Selectable::generateHash() {
+  switch (InfiniteLoopDetectionFingerprint) {
+  case FINGERPRINT_BLAKE2B: {
+    static_assert(sizeof(CryptoPP::byte) == sizeof(std::uint8_t),
+                  "CryptoPP::byte must be a single byte");
+    // context is reused: Final() restarts it for the next hash
+    static CryptoPP::BLAKE2b blake2b(false, 32);
+    blake2b.Update(data.data(), data.size());
+    blake2b.Final(buffer.data());
+    break;
+  }
+  case FINGERPRINT_FAST128:
+    FastHash::hash128(data.data(), data.size(), buffer.data());
+    std::fill(buffer.begin() + 16, buffer.end(), 0);
+    break;
+  }
+}
+
+void MemoryFingerprint_Selectable::clearHash() {
+  data.clear();
+}
+
+/* MemoryFingerprint_ostream<llvm::SmallVectorImpl<std::uint8_t>> */
+
+template <>
+void MemoryFingerprint_ostream<llvm::SmallVectorImpl<std::uint8_t>>::
+    write_impl(const char *ptr, std::size_t size) {
+  hash.append(reinterpret_cast<const std::uint8_t *>(ptr),
+              reinterpret_cast<const std::uint8_t *>(ptr) + size);
+  pos += size;
+}
+
+
 /* MemoryFingerprint_Dummy */
 
 void MemoryFingerprint_Dummy::updateUint8(const std::uint8_t value) {
@@ -67,6 +137,12 @@ void MemoryFingerprint_Dummy::updateUint64(const std::uint64_t value) {
   current += std::to_string(value);
 }
 
+void MemoryFingerprint_Dummy::updateBytes(const std::uint8_t *bytes,
+                                          std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i)
+    updateUint8(bytes[i]);
+}
+
 void MemoryFingerprint_Dummy::updateExpr(ref<Expr> expr) {
   if (first) {
     first = false;
@@ -93,7 +169,7 @@ std::string MemoryFingerprint_Dummy::toString_impl(MemoryFingerprintT::dummy_t f
   llvm::raw_string_ostream result(result_str);
   std::size_t writes = 0;
 
-  // show individual memory operations in detail: writes (per byte)
+  // show individual memory operations in detail: writes (per byte or chunk)
   bool showMemoryOperations = false;
 
   result << "{";
@@ -128,6 +204,22 @@ std::string MemoryFingerprint_Dummy::toString_impl(MemoryFingerprintT::dummy_t f
         }
         writes++;
         break;
+      case 7:
+        if (showMemoryOperations) {
+          std::uint64_t addr;
+          item >> addr;
+
+          result << "Write (chunk): ";
+          result << addr;
+          result << " =";
+
+          for (std::string line; std::getline(item, line); ) {
+            result << line;
+          }
+          output = true;
+        }
+        writes++;
+        break;
       case 3:
       case 4: {
         std::uintptr_t ptr;
@@ -3,6 +3,9 @@
 
 #include "klee/Config/config.h"
 #include "klee/Expr/Expr.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
+
+#include "llvm/ADT/SmallVector.h"
 
 #ifndef __cpp_rtti
 // stub for typeid to use CryptoPP without RTTI
@@ -17,6 +20,8 @@ template<typename T> const std::type_info& FakeTypeID(void) {
 #endif
 
 #include <array>
+#include <cstring>
+#include <functional>
 #include <iomanip>
 #include <set>
 #include <string>
@@ -25,10 +30,11 @@ template<typename T> const std::type_info& FakeTypeID(void) {
 namespace klee {
 
 class MemoryFingerprint_CryptoPP_BLAKE2b;
+class MemoryFingerprint_Selectable;
 class MemoryFingerprint_Dummy;
 
 // Set default implementation
-using MemoryFingerprint = MemoryFingerprint_CryptoPP_BLAKE2b;
+using MemoryFingerprint = MemoryFingerprint_Selectable;
 
 template<typename Derived, std::size_t hashSize>
 class MemoryFingerprintT {
@@ -52,7 +58,7 @@ private:
 
   template<typename T,
     typename std::enable_if<std::is_same<T, hash_t>::value, int>::type = 0>
-  inline void executeXOR(T &dst, const T &src) {
+  static inline void executeXOR(T &dst, const T &src) {
     for (std::size_t i = 0; i < hashSize; ++i) {
       dst[i] ^= src[i];
     }
@@ -60,7 +66,7 @@ private:
 
   template<typename T,
     typename std::enable_if<std::is_same<T, dummy_t>::value, int>::type = 0>
-  inline void executeXOR(T &dst, const T &src) {
+  static inline void executeXOR(T &dst, const T &src) {
     for (auto &elem : src) {
       auto pos = dst.find(elem);
       if (pos == dst.end()) {
@@ -108,6 +114,34 @@ public:
     getDerived().clearHash();
   }
 
+  // Same as applyToFingerprint() and applyToFingerprintAllocaDelta(), but
+  // apply a delta created by generateDelta() instead of the current updates.
+  void applyDeltaToFingerprint(const fingerprint_t &delta) {
+    executeXOR(fingerprint, delta);
+  }
+
+  void applyDeltaToFingerprintAllocaDelta(fingerprint_t &deltaDst,
+                                          const fingerprint_t &delta) {
+    executeXOR(deltaDst, delta);
+    executeXOR(fingerprint, delta);
+  }
+
+  void applyDeltaToFingerprintAllocaDelta(const fingerprint_t &delta) {
+    applyDeltaToFingerprintAllocaDelta(fingerprintAllocaDelta, delta);
+  }
+
+  // Store hash of current updates in delta without applying it, e.g. to cache
+  // it and apply it to a copy of the fingerprint later on with applyDelta().
+  void generateDelta(fingerprint_t &delta) {
+    getDerived().generateHash();
+    delta = buffer;
+    getDerived().clearHash();
+  }
+
+  static void applyDelta(fingerprint_t &dst, const fingerprint_t &delta) {
+    executeXOR(dst, delta);
+  }
+
   fingerprint_t getFingerprint() {
     fingerprint_t result = fingerprint;
     executeXOR(result, fingerprintLocalDelta);
@@ -170,6 +204,12 @@ public:
     }
   }
 
+  void updateExprContentHash(const Expr &expr) {
+    const Expr::ContentHash &hash = expr.contentHash();
+    getDerived().updateUint64(hash[0]);
+    getDerived().updateUint64(hash[1]);
+  }
+
   template<typename T,
     typename std::enable_if<std::is_same<T, hash_t>::value, int>::type = 0>
   static std::string toString(const T &fingerprint) {
@@ -187,6 +227,26 @@ public:
     return Derived::toString_impl(fingerprint);
   }
 
+  template<typename T,
+    typename std::enable_if<std::is_same<T, hash_t>::value, int>::type = 0>
+  static std::size_t hash(const T &fingerprint) {
+    // fingerprints are hash values already, so a prefix is sufficient
+    static_assert(hashSize >= sizeof(std::size_t), "fingerprint too short");
+    std::size_t result;
+    std::memcpy(&result, fingerprint.data(), sizeof(result));
+    return result;
+  }
+
+  template<typename T,
+    typename std::enable_if<std::is_same<T, dummy_t>::value, int>::type = 0>
+  static std::size_t hash(const T &fingerprint) {
+    std::size_t result = 0;
+    for (const std::string &elem : fingerprint) {
+      result ^= std::hash<std::string>()(elem);
+    }
+    return result;
+  }
+
   std::string getFingerprintAsString() {
     return toString(getFingerprint());
   }
@@ -212,6 +272,29 @@ private:
 public:
   void updateUint8(const std::uint8_t value);
   void updateUint64(const std::uint64_t value);
+  // same as updateUint8() for every byte
+  void updateBytes(const std::uint8_t *bytes, std::size_t size);
+  void updateExpr(ref<Expr> expr);
+};
+
+
+// Hash function is selected at startup (-infinite-loop-detection-fingerprint).
+// Updates are buffered until generateHash() is called, which then hashes the
+// whole buffer at once. Fingerprints of all backends have the same size, so
+// unused bytes of shorter hashes are always zero.
+class MemoryFingerprint_Selectable :
+public MemoryFingerprintT<MemoryFingerprint_Selectable, 32> {
+friend class MemoryFingerprintT<MemoryFingerprint_Selectable, 32>;
+private:
+  llvm::SmallVector<std::uint8_t, 64> data;
+  void generateHash();
+  void clearHash();
+
+public:
+  void updateUint8(const std::uint8_t value);
+  void updateUint64(const std::uint64_t value);
+  // same as updateUint8() for every byte
+  void updateBytes(const std::uint8_t *bytes, std::size_t size);
   void updateExpr(ref<Expr> expr);
 };
 
@@ -243,6 +326,8 @@ private:
 public:
   void updateUint8(const std::uint8_t value);
   void updateUint64(const std::uint64_t value);
+  // same as updateUint8() for every byte
+  void updateBytes(const std::uint8_t *bytes, std::size_t size);
   void updateExpr(ref<Expr> expr);
 };
 
@@ -1,6 +1,7 @@
 #include "MemoryState.h"
 
 #include "AddressSpace.h"
+#include "CoreStats.h"
 #include "ExecutionState.h"
 #include "Memory.h"
 
@@ -15,8 +16,12 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -24,17 +29,19 @@
 namespace klee {
 
 KModule *MemoryState::kmodule = nullptr;
-std::vector<llvm::Function *> MemoryState::outputFunctionsWhitelist;
-std::vector<llvm::Function *> MemoryState::inputFunctionsBlacklist;
-std::vector<llvm::Function *> MemoryState::libraryFunctionsList;
-std::vector<llvm::Function *> MemoryState::memoryFunctionsList;
+std::unordered_map<const llvm::Function *, std::uint8_t>
+    MemoryState::declarationClasses;
+std::size_t MemoryState::numClassifiedFunctions = 0;
+std::uint64_t MemoryState::nextFingerprintEpoch = 0;
 
 void MemoryState::setKModule(KModule *_kmodule) {
   if (kmodule != nullptr)
     return;
 
+  FunctionLists lists;
+
   // whitelist: output functions
-  const char *outputFunctions[] = {
+  lists.output = {
       // stdio.h
       "fflush", "fputc", "putc", "fputwc", "putwc", "fputs", "fputws",
       "putchar", "putwchar", "puts", "printf", "fprintf", "sprintf", "snprintf",
@@ -45,7 +52,7 @@ void MemoryState::setKModule(KModule *_kmodule) {
       "write"};
 
   // blacklist: input functions
-  const char *inputFunctions[] = {
+  lists.input = {
       // stdio.h
       "fopen", "freopen", "fread", "fgetc", "getc", "fgetwc", "getwc", "fgets",
       "fgetws", "getchar", "getwchar", "gets", "scanf", "fscanf", "sscanf",
@@ -70,7 +77,7 @@ void MemoryState::setKModule(KModule *_kmodule) {
       "fstat64", "lstat64", "open64", "readdir64", "stat64"};
 
   // library function that might use heavy loops that we do not want to inspect
-  const char *libraryFunctions[] = {
+  lists.library = {
       // string.h
       "memcmp", "memchr", "strcpy", "strncpy", "strcat", "strncat", "strxfrm",
       "strlen", "strcmp", "strncmp", "strcoll", "strchr", "strrchr", "strspn",
@@ -89,75 +96,233 @@ void MemoryState::setKModule(KModule *_kmodule) {
 
   // library functions with signature (*dest, _, count) that modify the memory
   // starting from dest for count bytes
-  const char *memoryFunctions[] = {"memset",  "memcpy",  "memmove",
-                                   "wmemset", "wmemcpy", "wmemmove"};
+  lists.memory = {"memset",  "memcpy",  "memmove",
+                  "wmemset", "wmemcpy", "wmemmove"};
+
+  // external functions without effects on memory (except for errno)
+  lists.pure = {
+      // math.h
+      "acos", "asin", "atan", "atan2", "cos", "sin", "tan", "cosh", "sinh",
+      "tanh", "exp", "exp2", "expm1", "log", "log10", "log2", "log1p", "pow",
+      "sqrt", "cbrt", "hypot", "ceil", "floor", "trunc", "round", "fabs",
+      "fmod", "fmin", "fmax", "ldexp", "acosf", "asinf", "atanf", "atan2f",
+      "cosf", "sinf", "tanf", "expf", "logf", "log10f", "powf", "sqrtf",
+      "ceilf", "floorf", "truncf", "roundf", "fabsf", "fmodf",
+
+      // POSIX
+      "getpid", "getppid", "getuid", "geteuid", "getgid", "getegid"};
+
+  // external functions that only modify memory their arguments point to
+  lists.argmem = {
+      // math.h
+      "frexp", "frexpf", "modf", "modff", "sincos", "sincosf"};
+
+  if (!InfiniteLoopDetectionFunctionLists.empty())
+    loadFunctionLists(InfiniteLoopDetectionFunctionLists, lists);
 
-  initializeFunctionList(_kmodule, outputFunctions, outputFunctionsWhitelist);
-  initializeFunctionList(_kmodule, inputFunctions, inputFunctionsBlacklist);
-  initializeFunctionList(_kmodule, libraryFunctions, libraryFunctionsList);
-  initializeFunctionList(_kmodule, memoryFunctions, memoryFunctionsList);
+  classifyFunctions(_kmodule, lists.output, FC_OUTPUT);
+  classifyFunctions(_kmodule, lists.input, FC_INPUT);
+  classifyFunctions(_kmodule, lists.library, FC_LIBRARY);
+  classifyFunctions(_kmodule, lists.memory, FC_MEMORY);
+  classifyFunctions(_kmodule, lists.pure, FC_PURE);
+  classifyFunctions(_kmodule, lists.argmem, FC_ARGMEM);
 
   kmodule = _kmodule;
 }
 
-template <std::size_t array_size>
-void MemoryState::initializeFunctionList(KModule *_kmodule,
-                                         const char *(&functions)[array_size],
-                                         std::vector<llvm::Function *> &list) {
-  std::vector<llvm::Function *> tmp;
-  for (const char *name : functions) {
+void MemoryState::loadFunctionLists(const std::string &path,
+                                    FunctionLists &lists) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) {
+    klee_error("Could not open function lists %s: %s", path.c_str(),
+               buffer.getError().message().c_str());
+  }
+
+  // YAML is a superset of JSON
+  llvm::SourceMgr sourceMgr;
+  llvm::yaml::Stream stream(buffer.get()->getBuffer(), sourceMgr);
+  auto document = stream.begin();
+  auto *root = document == stream.end()
+                   ? nullptr
+                   : llvm::dyn_cast_or_null<llvm::yaml::MappingNode>(
+                         document->getRoot());
+  if (root == nullptr) {
+    klee_error("Invalid function lists %s: expected a mapping", path.c_str());
+  }
+
+  FunctionLists loaded;
+  bool builtins = true;
+  for (auto &entry : *root) {
+    auto *keyNode =
+        llvm::dyn_cast_or_null<llvm::yaml::ScalarNode>(entry.getKey());
+    if (keyNode == nullptr) {
+      klee_error("Invalid function lists %s: expected a scalar key",
+                 path.c_str());
+    }
+    llvm::SmallString<16> keyStorage;
+    llvm::StringRef key = keyNode->getValue(keyStorage);
+
+    if (key == "builtins") {
+      auto *value =
+          llvm::dyn_cast_or_null<llvm::yaml::ScalarNode>(entry.getValue());
+      llvm::SmallString<8> valueStorage;
+      llvm::StringRef flag =
+          value ? value->getValue(valueStorage) : llvm::StringRef();
+      if (flag != "true" && flag != "false") {
+        klee_error("Invalid function lists %s: builtins has to be true or "
+                   "false",
+                   path.c_str());
+      }
+      builtins = (flag == "true");
+      continue;
+    }
+
+    std::vector<std::string> *list = nullptr;
+    if (key == "output") {
+      list = &loaded.output;
+    } else if (key == "input") {
+      list = &loaded.input;
+    } else if (key == "library") {
+      list = &loaded.library;
+    } else if (key == "memory") {
+      list = &loaded.memory;
+    } else if (key == "pure") {
+      list = &loaded.pure;
+    } else if (key == "argmem") {
+      list = &loaded.argmem;
+    } else {
+      klee_error("Invalid function lists %s: unknown list %s", path.c_str(),
+                 key.str().c_str());
+    }
+
+    auto *sequence =
+        llvm::dyn_cast_or_null<llvm::yaml::SequenceNode>(entry.getValue());
+    if (sequence == nullptr) {
+      klee_error("Invalid function lists %s: %s has to be a list",
+                 path.c_str(), key.str().c_str());
+    }
+    for (auto &item : *sequence) {
+      auto *name = llvm::dyn_cast<llvm::yaml::ScalarNode>(&item);
+      if (name == nullptr) {
+        klee_error("Invalid function lists %s: %s has to contain function "
+                   "names",
+                   path.c_str(), key.str().c_str());
+      }
+      llvm::SmallString<32> nameStorage;
+      list->emplace_back(name->getValue(nameStorage).str());
+    }
+  }
+  if (stream.failed()) {
+    klee_error("Invalid function lists %s: parse error", path.c_str());
+  }
+
+  if (!builtins) {
+    lists = std::move(loaded);
+    return;
+  }
+  for (auto pair : {std::make_pair(&lists.output, &loaded.output),
+                    std::make_pair(&lists.input, &loaded.input),
+                    std::make_pair(&lists.library, &loaded.library),
+                    std::make_pair(&lists.memory, &loaded.memory),
+                    std::make_pair(&lists.pure, &loaded.pure),
+                    std::make_pair(&lists.argmem, &loaded.argmem)}) {
+    pair.first->insert(pair.first->end(), pair.second->begin(),
+                       pair.second->end());
+  }
+}
+
+void MemoryState::classifyFunctions(KModule *_kmodule,
+                                    const std::vector<std::string> &functions,
+                                    std::uint8_t functionClass) {
+  for (const std::string &name : functions) {
     llvm::Function *f = _kmodule->module->getFunction(name);
     if (f == nullptr) {
       if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
         llvm::errs() << "MemoryState: could not find function in module: "
                      << name << "\n";
       }
+      continue;
+    }
+
+    if (functionClass == FC_MEMORY &&
+        (f->arg_size() < 3 || !f->arg_begin()->getType()->isPointerTy())) {
+      klee_warning("MemoryState: ignoring memory function %s with "
+                   "unexpected signature",
+                   name.c_str());
+      continue;
+    }
+
+    if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+      llvm::errs() << "MemoryState: found function in module: " << name
+                   << "\n";
+    }
+
+    std::uint8_t *classes;
+    if (f->isDeclaration()) {
+      classes = &declarationClasses[f];
     } else {
-      if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
-        llvm::errs() << "MemoryState: found function in module: " << name
-                     << "\n";
-      }
-      tmp.emplace_back(f);
+      classes = &_kmodule->functionMap.at(f)->functionClass;
     }
+    if (*classes == 0)
+      ++numClassifiedFunctions;
+    *classes |= functionClass;
   }
-  std::sort(tmp.begin(), tmp.end());
-  list = std::move(tmp);
+}
+
+std::uint8_t MemoryState::getFunctionClass(const llvm::Function *f,
+                                           const KFunction *kf) {
+  if (kf != nullptr)
+    return kf->functionClass;
+  if (declarationClasses.empty())
+    return 0;
+  auto it = declarationClasses.find(f);
+  return it != declarationClasses.end() ? it->second : 0;
 }
 
 void MemoryState::registerFunctionCall(const llvm::Function *f,
+                                       const KFunction *kf,
                                        std::size_t stackFrame,
                                        std::vector<ref<Expr>> &arguments) {
+  // has to happen before the new stack frame is pushed
+  materializeDirtyWrites();
+
+  // the new stack frame has not iterated any loops yet
+  if (loopIterations.size() >= stackFrame)
+    loopIterations.resize(stackFrame - 1);
+
   if (globalDisableMemoryState) {
-    // we only check for global disable and not for shadowed functions
-    // as we assume that those will not call any input functions
+    // calls within shadowed functions are still classified, as they may call
+    // input or memory functions themselves
     return;
   }
 
-  if (std::binary_search(inputFunctionsBlacklist.begin(),
-                         inputFunctionsBlacklist.end(), f)) {
+  std::uint8_t functionClass = getFunctionClass(f, kf);
+  if (functionClass == 0) {
+    return;
+  }
+
+  if (functionClass & FC_INPUT) {
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "MemoryState: blacklisted input function call to "
                    << f->getName() << "()\n";
     }
     clearEverything();
+    loopIterations.clear();
     enterShadowFunction(f, stackFrame);
-  } else if (std::binary_search(outputFunctionsWhitelist.begin(),
-                                outputFunctionsWhitelist.end(), f)) {
+  } else if (functionClass & FC_OUTPUT) {
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "MemoryState: whitelisted output function call to "
                    << f->getName() << "()\n";
     }
     enterShadowFunction(f, stackFrame);
-  } else if (std::binary_search(libraryFunctionsList.begin(),
-                                libraryFunctionsList.end(), f)) {
+  } else if (functionClass & FC_LIBRARY) {
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "MemoryState: library function call to " << f->getName()
                    << "()\n";
     }
     // we need to register changes to global memory
     enterShadowFunction(f, stackFrame, {}, true);
-  } else if (std::binary_search(memoryFunctionsList.begin(),
-                                memoryFunctionsList.end(), f)) {
+  } else if (functionClass & FC_MEMORY) {
     ConstantExpr *constAddr = dyn_cast<ConstantExpr>(arguments[0]);
     ConstantExpr *constSize = dyn_cast<ConstantExpr>(arguments[2]);
 
@@ -195,7 +360,8 @@ void MemoryState::registerFunctionCall(const llvm::Function *f,
 
 void MemoryState::registerFunctionRet(const llvm::Function *f,
                                       std::size_t stackFrame) {
-  if (f == shadowedFunction && stackFrame == shadowedStackFrame) {
+  if (!shadowStack.empty() && f == shadowStack.back().function &&
+      stackFrame == shadowStack.back().stackFrame) {
     leaveShadowFunction(f, stackFrame);
   }
 }
@@ -203,10 +369,44 @@ void MemoryState::registerFunctionRet(const llvm::Function *f,
 void MemoryState::clearEverything() {
   trace.clear();
   fingerprint.discardEverything();
+  dirtyObjects.clear();
+  staleObjects = {};
+  startFingerprintEpoch();
+}
+
+void MemoryState::registerMerge() {
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "MemoryState: merged state [fingerprint: "
+                 << fingerprint.getFingerprintAsString() << "]\n";
+  }
+
+  trace.clear();
+  // ranges of symbolic offsets only remain valid as long as constraints are
+  // only added, but the merged constraints are weaker
+  symbolicWriteRanges = {};
 }
 
-void MemoryState::registerExternalFunctionCall() {
-  if (shadowedFunction) {
+void MemoryState::registerExternalFunctionCall(
+    const llvm::Function *f, std::vector<const MemoryObject *> &&arguments) {
+  // external calls do not return through registerFunctionRet()
+  externalCallModeled = false;
+  externalWriteTargets.clear();
+
+  if (!shadowStack.empty()) {
+    return;
+  }
+
+  std::uint8_t functionClass = getFunctionClass(f, nullptr);
+  if (functionClass & (FC_PURE | FC_ARGMEM)) {
+    if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+      llvm::errs() << "MemoryState: modeled external function call to "
+                   << f->getName() << "()\n";
+    }
+    // the result is determined by the current memory state, only modified
+    // objects have to be rehashed (see registerExternalWrite())
+    externalCallModeled = true;
+    if (functionClass & FC_ARGMEM)
+      externalWriteTargets = std::move(arguments);
     return;
   }
 
@@ -216,8 +416,30 @@ void MemoryState::registerExternalFunctionCall() {
 
   // it is unknown whether control flow is changed by an external function, so
   // we cannot detect infinite loop iterations that started before this call
-  trace.clear();
-  fingerprint.discardEverything();
+  clearEverything();
+}
+
+void MemoryState::registerExternalWrite(const MemoryObject &mo,
+                                        const ObjectState &os, bool modified,
+                                        bool expected) {
+  if (modified) {
+    registerWrite(mo.getBaseExpr(), mo, os);
+    return;
+  }
+
+  if (externalCallModeled && !expected &&
+      std::find(externalWriteTargets.begin(), externalWriteTargets.end(),
+                &mo) == externalWriteTargets.end()) {
+    if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+      llvm::errs() << "MemoryState: unexpected write by external function to "
+                   << "ObjectState at base address "
+                   << ExprString(mo.getBaseExpr()) << "\n";
+    }
+    // the function class is wrong, fall back to an unknown external function
+    externalCallModeled = false;
+    clearEverything();
+  }
+  unregisterWrite(mo, os);
 }
 
 void MemoryState::registerWrite(ref<Expr> address, const MemoryObject &mo,
@@ -233,7 +455,7 @@ void MemoryState::registerWrite(ref<Expr> address, const MemoryObject &mo,
                  << "ObjectState at base address " << ExprString(base) << "\n";
   }
 
-  applyWriteFragment(address, mo, os, bytes);
+  applyWriteFragment(address, mo, os, bytes, true);
 
   if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
     llvm::errs() << " [fingerprint: " << fingerprint.getFingerprintAsString()
@@ -254,7 +476,7 @@ void MemoryState::unregisterWrite(ref<Expr> address, const MemoryObject &mo,
                  << "ObjectState at base address " << ExprString(base) << "\n";
   }
 
-  applyWriteFragment(address, mo, os, bytes);
+  applyWriteFragment(address, mo, os, bytes, false);
 
   if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
     llvm::errs() << " [fingerprint: " << fingerprint.getFingerprintAsString()
@@ -262,31 +484,98 @@ void MemoryState::unregisterWrite(ref<Expr> address, const MemoryObject &mo,
   }
 }
 
-void MemoryState::applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
-                                     const ObjectState &os, std::size_t bytes) {
-  ref<Expr> offset = mo.getOffsetExpr(address);
-  ConstantExpr *concreteOffset = dyn_cast<ConstantExpr>(offset);
+void MemoryState::excludeFromFingerprint(const MemoryObject &mo,
+                                         const ObjectState &os) {
+  if (mo.isExcludedFromFingerprint || excludedObjects.count(&mo)) {
+    return;
+  }
 
-  std::uint64_t begin = 0;
-  std::uint64_t end = os.size;
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "MemoryState: excluding ObjectState at base address "
+                 << ExprString(mo.getBaseExpr()) << " from fingerprint\n";
+  }
+
+  // pending lazy writes to mo are dropped as well
+  unregisterWrite(mo, os);
+  excludedObjects = excludedObjects.insert(&mo);
+}
+
+void MemoryState::registerFree(const MemoryObject &mo, const ObjectState &os) {
+  unregisterWrite(mo, os);
+  // the address might be reused by another object
+  excludedObjects = excludedObjects.remove(&mo);
+}
+
+void MemoryState::setSymbolicWriteRange(ref<Expr> offset,
+                                        std::uint64_t begin,
+                                        std::uint64_t end) {
+  const KInstruction *ki = executionState->prevPC;
+  symbolicWriteRanges = symbolicWriteRanges.replace({ki, {offset, begin, end}});
+
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "MemoryState: symbolic offset " << ExprString(offset)
+                 << " is within [+" << begin << ", +" << end << ")\n";
+  }
+}
+
+const MemoryState::SymbolicWriteRange *
+MemoryState::getSymbolicWriteRange(ref<Expr> offset) const {
+  const KInstruction *ki = executionState->prevPC;
+  if (const auto *entry = symbolicWriteRanges.lookup(ki)) {
+    if (entry->second.offset == offset) {
+      return &entry->second;
+    }
+  }
+  return nullptr;
+}
+
+bool MemoryState::getWriteTarget(
+    const MemoryObject &mo, bool &isLocal,
+    MemoryFingerprint::fingerprint_t *&externalDelta) {
+  isLocal = false;
+  externalDelta = nullptr;
 
-  bool isLocal = false;
-  MemoryFingerprint::fingerprint_t *externalDelta = nullptr;
+  if (mo.isExcludedFromFingerprint || excludedObjects.count(&mo)) {
+    return false;
+  }
 
   if (mo.isLocal) {
-    isLocal = true;
-    if (!trace.isAllocaAllocationInCurrentStackFrame(*executionState, mo)) {
-      externalDelta = trace.getPreviousAllocaDelta(*executionState, mo);
-      if (externalDelta == nullptr) {
-        // allocation was made in previous stack frame that is not available
-        // anymore due to an external function call
-        isLocal = false;
+    // Stack frames within a shadowed function are not part of the memory
+    // trace, the stack frame of the outermost shadowed function is the last
+    // one (there is none for external functions).
+    std::size_t stackSize = executionState->stack.size();
+    if (!shadowStack.empty())
+      stackSize = std::min(stackSize, shadowStack.front().stackFrame);
+
+    if (MemoryTrace::isAllocaAllocationInCurrentStackFrame(stackSize, mo)) {
+      if (!shadowStack.empty()) {
+        // change is only to be made to allocaDelta of current stack frame or
+        // to a stack frame within the shadowed function
+        return false;
       }
+      isLocal = true;
+    } else {
+      externalDelta = trace.getPreviousAllocaDelta(stackSize, mo);
+      // otherwise, allocation was made in previous stack frame that is not
+      // available anymore due to an external function call
+      isLocal = (externalDelta != nullptr);
     }
   }
+  return true;
+}
+
+void MemoryState::applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
+                                     const ObjectState &os, std::size_t bytes,
+                                     bool registration) {
+  ref<Expr> offset = mo.getOffsetExpr(address);
+  ConstantExpr *concreteOffset = dyn_cast<ConstantExpr>(offset);
+
+  std::uint64_t begin = 0;
+  std::uint64_t end = os.size;
 
-  if (shadowedFunction && isLocal && externalDelta == nullptr) {
-    // change is only to be made to allocaDelta of current stack frame
+  bool isLocal;
+  MemoryFingerprint::fingerprint_t *externalDelta;
+  if (!getWriteTarget(mo, isLocal, externalDelta)) {
     return;
   }
 
@@ -296,27 +585,264 @@ void MemoryState::applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
     if ((begin + bytes) < os.size) {
       end = begin + bytes;
     }
+  } else if (const SymbolicWriteRange *range = getSymbolicWriteRange(offset)) {
+    // symbolic offsets: only hash indices that can be changed
+    begin = range->begin;
+    end = std::min(range->end, end);
+  }
+
+  if (!registration) {
+    refreshStaleBytes(mo, os, begin, end, isLocal, externalDelta);
+
+    if (!concreteOffset && (begin > 0 || end < os.size) &&
+        !staleObjects.count(&mo)) {
+      // bytes outside of the range keep their contribution from before the
+      // write, which has to be computed from a snapshot when removing it
+      if (InfiniteLoopDetectionLazyWrites) {
+        // dirty bytes have no contribution at all, add them first
+        materializeDirtyWrites();
+      }
+      std::uint64_t freshBegin = begin;
+      std::uint64_t freshEnd = end;
+      if (InfiniteLoopDetectionWriteHashing == HASH_WRITES_PER_CHUNK) {
+        // whole chunks are rehashed
+        std::uint64_t chunkSize =
+            std::max(1u, InfiniteLoopDetectionChunkSize.getValue());
+        freshBegin -= freshBegin % chunkSize;
+        freshEnd = std::min(
+            freshEnd + (chunkSize - freshEnd % chunkSize) % chunkSize,
+            static_cast<std::uint64_t>(os.size));
+      }
+      staleObjects = staleObjects.insert(
+          {&mo, {new ObjectState(os), freshBegin, freshEnd}});
+    }
+  }
+
+  if (InfiniteLoopDetectionLazyWrites) {
+    markDirty(mo, os, begin, end, registration, isLocal, externalDelta);
+  } else {
+    applyWriteRange(mo, os, begin, end, isLocal, externalDelta);
+  }
+}
+
+void MemoryState::refreshStaleBytes(
+    const MemoryObject &mo, const ObjectState &os, std::uint64_t begin,
+    std::uint64_t end, bool isLocal,
+    MemoryFingerprint::fingerprint_t *externalDelta) {
+  const auto *stale = staleObjects.lookup(&mo);
+  if (stale == nullptr || begin >= end ||
+      (stale->second.freshBegin <= begin && end <= stale->second.freshEnd)) {
+    return;
+  }
+
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "MemoryState: rehashing stale bytes outside of [+"
+                 << stale->second.freshBegin << ", +"
+                 << stale->second.freshEnd << ")\n";
+  }
+
+  // replace contributions of the snapshot by the current ones
+  ref<ObjectState> snapshot = stale->second.snapshot;
+  std::uint64_t freshBegin = stale->second.freshBegin;
+  std::uint64_t freshEnd = stale->second.freshEnd;
+  staleObjects = staleObjects.remove(&mo);
+  const ObjectState *versions[] = {snapshot.get(), &os};
+  for (const ObjectState *version : versions) {
+    applyWriteRange(mo, *version, 0, freshBegin, isLocal, externalDelta);
+    applyWriteRange(mo, *version, freshEnd, os.size, isLocal, externalDelta);
+  }
+}
+
+void MemoryState::dropLocals(std::size_t stackFrame) {
+  auto isDropped = [stackFrame](const MemoryObject *mo) {
+    return mo->isLocal &&
+           MemoryTrace::isAllocaAllocationInCurrentStackFrame(stackFrame, *mo);
+  };
+
+  // the contributions of locals of the stack frame are discarded with it
+  std::vector<const MemoryObject *> dropped;
+  for (const auto &stale : staleObjects) {
+    if (isDropped(stale.first)) {
+      dropped.push_back(stale.first);
+    }
+  }
+  for (const MemoryObject *mo : dropped) {
+    staleObjects = staleObjects.remove(mo);
+  }
+
+  // and their addresses might be reused by other objects
+  dropped.clear();
+  for (const MemoryObject *mo : excludedObjects) {
+    if (isDropped(mo)) {
+      dropped.push_back(mo);
+    }
+  }
+  for (const MemoryObject *mo : dropped) {
+    excludedObjects = excludedObjects.remove(mo);
+  }
+}
+
+void MemoryState::markDirty(const MemoryObject &mo, const ObjectState &os,
+                            std::uint64_t begin, std::uint64_t end,
+                            bool registration, bool isLocal,
+                            MemoryFingerprint::fingerprint_t *externalDelta) {
+  if (begin >= end) {
+    return;
+  }
+
+  if (InfiniteLoopDetectionWriteHashing == HASH_WRITES_PER_CHUNK) {
+    // only track whole chunks, so that no chunk is hashed twice
+    std::uint64_t chunkSize =
+        std::max(1u, InfiniteLoopDetectionChunkSize.getValue());
+    begin -= begin % chunkSize;
+    end = std::min(end + (chunkSize - end % chunkSize) % chunkSize,
+                   static_cast<std::uint64_t>(os.size));
+  }
+
+  DirtyObject &dirty = dirtyObjects[&mo];
+  if (!dirty.mo) {
+    dirty.mo = &mo;
+  }
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> &ranges = dirty.ranges;
+
+  if (!registration) {
+    // Remove previous value of all bytes that are still part of the
+    // fingerprint. Dirty bytes have already been removed by a previous
+    // write and are added again with their final value on materialization.
+    std::uint64_t pos = begin;
+    for (const auto &range : ranges) {
+      if (range.second <= pos)
+        continue;
+      if (range.first >= end)
+        break;
+      if (range.first > pos)
+        applyWriteRange(mo, os, pos, range.first, isLocal, externalDelta);
+      pos = std::max(pos, range.second);
+    }
+    if (pos < end)
+      applyWriteRange(mo, os, pos, end, isLocal, externalDelta);
+  } else if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "[+" << begin << ", +" << end << ") marked dirty\n";
+  }
+
+  // insert [begin, end) into sorted, disjoint ranges and merge overlapping or
+  // adjacent ones
+  auto pos = std::lower_bound(
+      ranges.begin(), ranges.end(), begin,
+      [](const std::pair<std::uint64_t, std::uint64_t> &range,
+         std::uint64_t value) { return range.second < value; });
+  auto last = pos;
+  while (last != ranges.end() && last->first <= end) {
+    begin = std::min(begin, last->first);
+    end = std::max(end, last->second);
+    ++last;
+  }
+  pos = ranges.erase(pos, last);
+  ranges.insert(pos, {begin, end});
+}
+
+void MemoryState::materializeDirtyWrites() {
+  if (disableMemoryState || dirtyObjects.empty()) {
+    return;
   }
 
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "MemoryState: materializing writes to "
+                 << dirtyObjects.size() << " ObjectStates\n";
+  }
+
+  for (const auto &entry : dirtyObjects) {
+    const DirtyObject &dirty = entry.second;
+    const MemoryObject &mo = *dirty.mo;
+    const ObjectState *os = executionState->addressSpace.findObject(&mo);
+    bool isLocal;
+    MemoryFingerprint::fingerprint_t *externalDelta;
+    if (os == nullptr || !getWriteTarget(mo, isLocal, externalDelta)) {
+      // object has been deallocated in the meantime
+      continue;
+    }
+    for (const auto &range : dirty.ranges) {
+      applyWriteRange(mo, *os, range.first, range.second, isLocal,
+                      externalDelta);
+    }
+  }
+  dirtyObjects.clear();
+
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << " [fingerprint: " << fingerprint.getFingerprintAsString()
+                 << "]\n";
+  }
+}
+
+void MemoryState::applyWriteRange(
+    const MemoryObject &mo, const ObjectState &os, std::uint64_t begin,
+    std::uint64_t end, bool isLocal,
+    MemoryFingerprint::fingerprint_t *externalDelta) {
   ref<ConstantExpr> base = mo.getBaseExpr();
+  std::uint64_t baseAddress = base->getZExtValue(64);
+
+  if (InfiniteLoopDetectionWriteHashing == HASH_WRITES_PER_CHUNK) {
+    // Chunks are aligned to the start of the object and always rehashed as a
+    // whole, so that the contribution of a chunk can be removed again by
+    // unregistering any (partial) range that overlaps with it.
+    std::uint64_t chunkSize =
+        std::max(1u, InfiniteLoopDetectionChunkSize.getValue());
+
+    // Contributions cached with the ObjectState are exactly the values that
+    // were last added to the fingerprint, as every write invalidates them.
+    bool cache = InfiniteLoopDetectionCacheObjectContributions;
+    if (cache && os.validFingerprintContributions.empty()) {
+      std::size_t chunks = (os.size + chunkSize - 1) / chunkSize;
+      os.fingerprintContributions.resize(chunks);
+      os.validFingerprintContributions.assign(chunks, false);
+    }
 
-  for (std::uint64_t i = begin; i < end; i++) {
-    std::uint64_t baseAddress = base->getZExtValue(64);
+    for (std::uint64_t chunk = begin - (begin % chunkSize); chunk < end;
+         chunk += chunkSize) {
+      std::uint64_t chunkEnd =
+          std::min(chunk + chunkSize, static_cast<std::uint64_t>(os.size));
+
+      if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+        llvm::errs() << "[+" << chunk << ", +" << chunkEnd << ")";
+      }
 
+      if (cache) {
+        std::size_t index = chunk / chunkSize;
+        if (!os.validFingerprintContributions[index]) {
+          hashChunk(os, baseAddress, chunk, chunkEnd);
+          fingerprint.generateDelta(os.fingerprintContributions[index]);
+          os.validFingerprintContributions[index] = true;
+        } else if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+          llvm::errs() << " (cached)";
+        }
+        applyToFingerprint(isLocal, externalDelta,
+                           os.fingerprintContributions[index]);
+      } else {
+        hashChunk(os, baseAddress, chunk, chunkEnd);
+        applyToFingerprint(isLocal, externalDelta);
+      }
+
+      if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+        llvm::errs() << "\n";
+      }
+    }
+    return;
+  }
+
+  for (std::uint64_t i = begin; i < end; i++) {
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "[+" << i << "] ";
     }
 
     // add value of byte at offset to fingerprint
-    ref<Expr> valExpr = os.read8(i);
-    if (ConstantExpr *constant = dyn_cast<ConstantExpr>(valExpr)) {
-      // concrete value
+    if (const std::uint8_t *concrete = os.readConcreteRange(i, i + 1)) {
+      // concrete value (read without creating a ConstantExpr)
       fingerprint.updateUint8(1);
 
       // add base address + offset to fingerprint
       fingerprint.updateUint64(baseAddress + i);
 
-      std::uint8_t value = constant->getZExtValue(8);
+      std::uint8_t value = *concrete;
       fingerprint.updateUint8(value);
       if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
         llvm::errs() << "0x";
@@ -324,6 +850,7 @@ void MemoryState::applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
       }
     } else {
       // symbolic value
+      ref<Expr> valExpr = os.read8(i);
       fingerprint.updateUint8(2);
 
       // add base address + offset to fingerprint
@@ -335,17 +862,7 @@ void MemoryState::applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
       }
     }
 
-    if (isLocal) {
-      if (externalDelta == nullptr) {
-        // current stack frame
-        fingerprint.applyToFingerprintAllocaDelta();
-      } else {
-        // previous stack frame that is still available
-        fingerprint.applyToFingerprintAllocaDelta(*externalDelta);
-      }
-    } else {
-      fingerprint.applyToFingerprint();
-    }
+    applyToFingerprint(isLocal, externalDelta);
 
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       if (i % 10 == 9) {
@@ -357,83 +874,339 @@ void MemoryState::applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
   }
 }
 
-void MemoryState::registerBasicBlock(const llvm::BasicBlock &bb) {
-  if (disableMemoryState) {
+void MemoryState::hashChunk(const ObjectState &os, std::uint64_t baseAddress,
+                            std::uint64_t chunk, std::uint64_t chunkEnd) {
+  if (const std::uint8_t *bytes = os.readConcreteRange(chunk, chunkEnd)) {
+    // Concrete chunk (e.g. written by memset or memcpy): hash its contents
+    // as a single run straight from the concrete store. The different tag
+    // separates it from the byte-wise encoding below.
+    fingerprint.updateUint8(8);
+    fingerprint.updateUint64(baseAddress + chunk);
+    fingerprint.updateBytes(bytes, chunkEnd - chunk);
     return;
   }
 
-  // apply live locals to copy of fingerprint
-  auto copy = fingerprint;
-  KFunction *kf = getKFunction(&bb);
-  for (auto &index : kf->getLiveLocals(bb).args) {
-    ref<Expr> value = getArgumentValue(kf, index);
-    if (ConstantExpr *constant = dyn_cast<ConstantExpr>(value)) {
+  fingerprint.updateUint8(7);
+  // add base address + offset of chunk to fingerprint
+  fingerprint.updateUint64(baseAddress + chunk);
+
+  for (std::uint64_t i = chunk; i < chunkEnd; i++) {
+    ref<Expr> valExpr = os.read8(i);
+    if (ConstantExpr *constant = dyn_cast<ConstantExpr>(valExpr)) {
       // concrete value
-      copy.updateUint8(5);
-      copy.updateUint64(reinterpret_cast<std::uintptr_t>(kf));
-      copy.updateUint64(index);
-      copy.updateConstantExpr(*constant);
+      fingerprint.updateUint8(1);
+      fingerprint.updateUint8(constant->getZExtValue(8));
     } else {
       // symbolic value
-      copy.updateUint8(6);
-      copy.updateUint64(reinterpret_cast<std::uintptr_t>(kf));
-      copy.updateUint64(index);
-      copy.updateExpr(value);
+      fingerprint.updateUint8(2);
+      fingerprint.updateExpr(valExpr);
+    }
+  }
+}
+
+void MemoryState::applyToFingerprint(
+    bool isLocal, MemoryFingerprint::fingerprint_t *externalDelta,
+    const MemoryFingerprint::fingerprint_t &delta) {
+  if (isLocal) {
+    if (externalDelta == nullptr) {
+      // current stack frame
+      fingerprint.applyDeltaToFingerprintAllocaDelta(delta);
+    } else {
+      // previous stack frame that is still available
+      fingerprint.applyDeltaToFingerprintAllocaDelta(*externalDelta, delta);
+    }
+  } else {
+    fingerprint.applyDeltaToFingerprint(delta);
+  }
+}
+
+void MemoryState::applyToFingerprint(
+    bool isLocal, MemoryFingerprint::fingerprint_t *externalDelta) {
+  if (isLocal) {
+    if (externalDelta == nullptr) {
+      // current stack frame
+      fingerprint.applyToFingerprintAllocaDelta();
+    } else {
+      // previous stack frame that is still available
+      fingerprint.applyToFingerprintAllocaDelta(*externalDelta);
+    }
+  } else {
+    fingerprint.applyToFingerprint();
+  }
+}
+
+MemoryFingerprint::fingerprint_t
+MemoryState::getBasicBlockFingerprint(const KFunction *kf, unsigned id) {
+  materializeDirtyWrites();
+
+  // apply live locals to copy of fingerprint
+  MemoryFingerprint::fingerprint_t result = fingerprint.getFingerprint();
+  const KFunction::liveset_t liveSet = kf->getLiveLocals(id);
+  const StackFrame &sf = executionState->stack.back();
+  if (sf.validFingerprintContributions.size() != kf->numRegisters) {
+    sf.fingerprintContributions.resize(kf->numRegisters);
+    sf.validFingerprintContributions.assign(kf->numRegisters, false);
+  }
+
+  for (auto &index : liveSet.args) {
+    unsigned reg = kf->getArgRegister(index);
+    bool cached = sf.validFingerprintContributions[reg];
+    if (!cached) {
+      ref<Expr> value = getArgumentValue(kf, index);
+      if (ConstantExpr *constant = dyn_cast<ConstantExpr>(value)) {
+        // concrete value
+        fingerprint.updateUint8(5);
+        fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(kf));
+        fingerprint.updateUint64(index);
+        fingerprint.updateConstantExpr(*constant);
+      } else {
+        // symbolic value
+        fingerprint.updateUint8(6);
+        fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(kf));
+        fingerprint.updateUint64(index);
+        fingerprint.updateExpr(value);
+      }
+      fingerprint.generateDelta(sf.fingerprintContributions[reg]);
+      sf.validFingerprintContributions[reg] = true;
     }
-    copy.applyToFingerprintLocalDelta();
+    MemoryFingerprint::applyDelta(result, sf.fingerprintContributions[reg]);
 
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "MemoryState: Add live argument " << index
                    << " to function " << kf->function->getName() << " = "
-                   << ExprString(value)
-                   << " [fingerprint: " << copy.getFingerprintAsString()
-                   << "]\n";
+                   << ExprString(getArgumentValue(kf, index))
+                   << (cached ? " (cached)" : "") << " [fingerprint: "
+                   << MemoryFingerprint::toString(result) << "]\n";
     }
   }
-  for (auto &ki : kf->getLiveLocals(bb).inst) {
-    ref<Expr> value = getLocalValue(ki);
-    if (ConstantExpr *constant = dyn_cast<ConstantExpr>(value)) {
-      // concrete value
-      copy.updateUint8(3);
-      copy.updateUint64(reinterpret_cast<std::uintptr_t>(ki->inst));
-      copy.updateConstantExpr(*constant);
-    } else {
-      // symbolic value
-      copy.updateUint8(4);
-      copy.updateUint64(reinterpret_cast<std::uintptr_t>(ki->inst));
-      copy.updateExpr(value);
+  for (auto &ki : liveSet.inst) {
+    bool cached = sf.validFingerprintContributions[ki->dest];
+    if (!cached) {
+      ref<Expr> value = getLocalValue(ki);
+      if (ConstantExpr *constant = dyn_cast<ConstantExpr>(value)) {
+        // concrete value
+        fingerprint.updateUint8(3);
+        fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(ki->inst));
+        fingerprint.updateConstantExpr(*constant);
+      } else {
+        // symbolic value
+        fingerprint.updateUint8(4);
+        fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(ki->inst));
+        fingerprint.updateExpr(value);
+      }
+      fingerprint.generateDelta(sf.fingerprintContributions[ki->dest]);
+      sf.validFingerprintContributions[ki->dest] = true;
     }
-    copy.applyToFingerprintLocalDelta();
+    MemoryFingerprint::applyDelta(result,
+                                  sf.fingerprintContributions[ki->dest]);
 
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "MemoryState: Add live local %" << ki->inst->getName()
-                   << " = " << ExprString(value)
-                   << " [fingerprint: " << copy.getFingerprintAsString()
-                   << "]\n";
+                   << " = " << ExprString(getLocalValue(ki))
+                   << (cached ? " (cached)" : "") << " [fingerprint: "
+                   << MemoryFingerprint::toString(result) << "]\n";
     }
   }
 
+  return result;
+}
+
+void MemoryState::registerBasicBlock(const KFunction *kf, unsigned id) {
+  if (disableMemoryState) {
+    return;
+  }
+
+  MemoryFingerprint::fingerprint_t result = getBasicBlockFingerprint(kf, id);
+
+  const KInstruction *inst = kf->instructions[kf->basicBlocks[id].entry];
+
+  if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
+    llvm::errs() << "MemoryState: Register BasicBlock "
+                 << inst->inst->getParent()->getName()
+                 << " [fingerprint: " << MemoryFingerprint::toString(result)
+                 << "]\n";
+  }
+
+  trace.registerBasicBlock(inst, result);
+}
+
+bool MemoryState::getStateFingerprint(
+    const KFunction *kf, unsigned id,
+    MemoryFingerprint::fingerprint_t &result) {
+  if (disableMemoryState) {
+    return false;
+  }
+
+  result = getBasicBlockFingerprint(kf, id);
+
+  // locals of calling stack frames are not part of the fingerprint
+  std::size_t stackSize = executionState->stack.size();
+  MemoryFingerprint::applyDelta(result, getCallersFingerprint(stackSize - 1));
+
+  fingerprint.updateUint8(9);
+  fingerprint.updateUint64(fingerprintEpoch);
+  fingerprint.updateUint64(stackSize);
+  fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(
+      kf->instructions[kf->basicBlocks[id].entry]));
+  MemoryFingerprint::fingerprint_t delta;
+  fingerprint.generateDelta(delta);
+  MemoryFingerprint::applyDelta(result, delta);
+
   if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
-    llvm::errs() << "MemoryState: Register BasicBlock " << bb.getName()
-                 << " [fingerprint: " << copy.getFingerprintAsString() << "]\n";
+    llvm::errs() << "MemoryState: state fingerprint (epoch "
+                 << fingerprintEpoch
+                 << "): " << MemoryFingerprint::toString(result) << "\n";
+  }
+  return true;
+}
+
+const MemoryFingerprint::fingerprint_t &
+MemoryState::getCallersFingerprint(std::size_t stackFrame) {
+  const auto &stack = executionState->stack;
+
+  // find the closest stack frame with a valid fingerprint of its callers
+  std::size_t valid = stackFrame;
+  while (valid > 0 && !stack[valid].validCallersFingerprint)
+    --valid;
+  if (!stack[valid].validCallersFingerprint) {
+    // bottom most stack frame
+    stack[valid].callersFingerprint = {};
+    stack[valid].validCallersFingerprint = true;
+  }
+
+  for (std::size_t i = valid + 1; i <= stackFrame; ++i) {
+    const StackFrame &caller = stack[i - 1];
+    fingerprint.updateUint8(10);
+    fingerprint.updateUint64(i - 1);
+    fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(caller.kf));
+    fingerprint.updateUint64(reinterpret_cast<std::uintptr_t>(
+        static_cast<KInstruction *>(stack[i].caller)));
+    for (unsigned reg = 0; reg < caller.kf->numRegisters; ++reg) {
+      const ref<Expr> &value = caller.locals[reg].value;
+      if (value.isNull())
+        continue;
+      fingerprint.updateUint64(reg);
+      if (ConstantExpr *constant = dyn_cast<ConstantExpr>(value)) {
+        fingerprint.updateUint8(1);
+        fingerprint.updateConstantExpr(*constant);
+      } else {
+        fingerprint.updateUint8(2);
+        fingerprint.updateExpr(value);
+      }
+    }
+    MemoryFingerprint::fingerprint_t delta;
+    fingerprint.generateDelta(delta);
+    stack[i].callersFingerprint = stack[i - 1].callersFingerprint;
+    MemoryFingerprint::applyDelta(stack[i].callersFingerprint, delta);
+    stack[i].validCallersFingerprint = true;
+  }
+
+  return stack[stackFrame].callersFingerprint;
+}
+
+void MemoryState::registerLoopTransition(const KFunction *kf, unsigned src,
+                                         unsigned dst) {
+  if (disableMemoryState) {
+    return;
   }
 
-  const KInstruction *inst = getKInstruction(&bb);
-  trace.registerBasicBlock(inst, copy.getFingerprint());
+  if (InfiniteLoopDetectionMaxLoopIterations)
+    leaveIrreducibleCycles(kf, dst);
+
+  unsigned from = kf->basicBlocks[src].loop;
+  unsigned to = kf->basicBlocks[dst].loop;
+  if (from == to) {
+    return;
+  }
+
+  // innermost loop that contains both basic blocks
+  unsigned common = from;
+  unsigned other = to;
+  while (kf->loops[common].depth > kf->loops[other].depth)
+    common = kf->loops[common].parent;
+  while (kf->loops[other].depth > kf->loops[common].depth)
+    other = kf->loops[other].parent;
+  while (common != other) {
+    common = kf->loops[common].parent;
+    other = kf->loops[other].parent;
+  }
+
+  unsigned depth = kf->loops[common].depth;
+  if (kf->loops[from].depth > depth) {
+    if (InfiniteLoopDetectionTruncateLoops)
+      trace.leaveLoops(depth);
+    if (InfiniteLoopDetectionMaxLoopIterations)
+      leaveLoopIterations(kf, depth);
+  }
+  if (kf->loops[to].depth > depth && InfiniteLoopDetectionTruncateLoops) {
+    trace.enterLoop(kf->loops[to].depth);
+  }
+}
+
+// highest iteration count of a loop that has been left
+static void recordLoopIterations(std::uint64_t count) {
+  if (count > stats::maxLoopIterations)
+    stats::maxLoopIterations += count - stats::maxLoopIterations;
 }
 
-KInstruction *MemoryState::getKInstruction(const llvm::BasicBlock *bb) const {
-  KFunction *kf = getKFunction(bb);
-  unsigned entry = kf->basicBlockEntry[const_cast<llvm::BasicBlock *>(bb)];
-  return kf->instructions[entry];
+void MemoryState::leaveLoopIterations(const KFunction *kf, unsigned depth) {
+  std::size_t frame = executionState->stack.size() - 1;
+  if (frame >= loopIterations.size())
+    return;
+
+  // remove the counts of all loops deeper than depth
+  auto &counts = loopIterations[frame];
+  auto kept = counts.begin();
+  for (auto it = counts.begin(); it != counts.end(); ++it) {
+    if (kf->loops[kf->basicBlocks[it->first].loop].depth <= depth) {
+      *kept++ = *it;
+    } else {
+      recordLoopIterations(it->second);
+    }
+  }
+  counts.erase(kept, counts.end());
+}
+
+void MemoryState::leaveIrreducibleCycles(const KFunction *kf, unsigned id) {
+  std::size_t frame = executionState->stack.size() - 1;
+  if (frame >= loopIterations.size())
+    return;
+
+  // Irreducible cycles are not natural loops, so their counts are removed as
+  // soon as a basic block outside of the cycle is reached.
+  auto &counts = loopIterations[frame];
+  auto kept = counts.begin();
+  for (auto it = counts.begin(); it != counts.end(); ++it) {
+    llvm::ArrayRef<unsigned> cycle = kf->getIrreducibleCycle(it->first);
+    if (cycle.empty() || std::binary_search(cycle.begin(), cycle.end(), id)) {
+      *kept++ = *it;
+    } else {
+      recordLoopIterations(it->second);
+    }
+  }
+  counts.erase(kept, counts.end());
 }
 
-KFunction *MemoryState::getKFunction(const llvm::BasicBlock *bb) const {
-  llvm::Function *f = const_cast<llvm::Function *>(bb->getParent());
-  assert(f != nullptr && "failed to retrieve Function for BasicBlock");
-  KFunction *kf = kmodule->functionMap[f];
-  assert(kf != nullptr && "failed to retrieve KFunction");
-  return kf;
+std::uint64_t MemoryState::registerLoopIteration(unsigned id) {
+  if (disableMemoryState) {
+    return 0;
+  }
+
+  std::size_t frame = executionState->stack.size() - 1;
+  if (frame >= loopIterations.size())
+    loopIterations.resize(frame + 1);
+
+  auto &counts = loopIterations[frame];
+  auto it = std::find_if(
+      counts.begin(), counts.end(),
+      [id](const std::pair<unsigned, std::uint64_t> &count) {
+        return count.first == id;
+      });
+  if (it == counts.end()) {
+    counts.emplace_back(id, 1);
+    return 1;
+  }
+  return ++it->second;
 }
 
 ref<Expr> MemoryState::getArgumentValue(const KFunction *kf,
@@ -482,46 +1255,49 @@ bool MemoryState::findInfiniteRecursion() const {
 void MemoryState::enterShadowFunction(
     const llvm::Function *f, std::size_t stackFrame,
     std::function<void(MemoryState &)> &&callback, bool registerGlobals) {
-  if (shadowedFunction) {
-    return; // only one function can be entered at a time
-  }
-
   if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
     llvm::errs() << "MemoryState: entering shadowed function: " << f->getName()
-                 << "\n";
+                 << " (depth " << shadowStack.size() << ")\n";
   }
 
-  shadowedFunction = f;
-  shadowedStackFrame = stackFrame;
-  shadowCallback = std::move(callback);
-  registerGlobalsInShadow = registerGlobals;
+  if (!shadowStack.empty())
+    registerGlobals = registerGlobals && shadowStack.back().registerGlobals;
+  shadowStack.push_back({f, stackFrame, std::move(callback), registerGlobals});
   updateDisableMemoryState();
 }
 
 void MemoryState::leaveShadowFunction(const llvm::Function *f,
                                       std::size_t stackFrame) {
-  assert(f == shadowedFunction);
-  assert(stackFrame == shadowedStackFrame);
+  assert(!shadowStack.empty());
+  assert(f == shadowStack.back().function);
+  assert(stackFrame == shadowStack.back().stackFrame);
 
   if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
-    llvm::errs() << "MemoryState: leaving shadowed function: "
-                 << shadowedFunction->getName() << "\n";
+    llvm::errs() << "MemoryState: leaving shadowed function: " << f->getName()
+                 << " (depth " << (shadowStack.size() - 1) << ")\n";
   }
 
-  if (shadowCallback) {
-    shadowCallback(*this);
-    shadowCallback = {};
-  }
-  shadowedFunction = nullptr;
-  shadowedStackFrame = 0;
-  registerGlobalsInShadow = false;
+  // the callback is executed in the context of the enclosing shadowed
+  // function (if any), as it registers changes made by the one left
+  std::function<void(MemoryState &)> callback =
+      std::move(shadowStack.back().callback);
+  bool registeredGlobals = shadowStack.back().registerGlobals;
+  shadowStack.pop_back();
   updateDisableMemoryState();
+
+  if (callback) {
+    callback(*this);
+  } else if (!registeredGlobals) {
+    // changes to memory made by the shadowed function have not been
+    // registered
+    startFingerprintEpoch();
+  }
 }
 
 void MemoryState::registerPushFrame(const llvm::Function *function,
                                     std::size_t stackFrame) {
 
-  if (disableMemoryState && stackFrame != shadowedStackFrame) {
+  if (disableMemoryState && !isOutermostShadowedStackFrame(stackFrame)) {
     return;
   }
 
@@ -550,10 +1326,19 @@ void MemoryState::registerPopFrame(std::size_t stackFrame,
                                    const llvm::BasicBlock *callerBB) {
   // IMPORTANT: has to be called prior to state.popFrame()
 
-  if (disableMemoryState && stackFrame != shadowedStackFrame) {
+  // all loops of the stack frame that is to be left are left as well
+  if (stackFrame - 1 < loopIterations.size()) {
+    for (const auto &count : loopIterations[stackFrame - 1])
+      recordLoopIterations(count.second);
+    loopIterations.resize(stackFrame - 1);
+  }
+
+  if (disableMemoryState && !isOutermostShadowedStackFrame(stackFrame)) {
     return;
   }
 
+  materializeDirtyWrites();
+
   if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
     llvm::errs() << "MemoryState: POPFRAME ("
                  << returningBB->getParent()->getName() << " returning to "
@@ -562,6 +1347,8 @@ void MemoryState::registerPopFrame(std::size_t stackFrame,
                  << "\n";
   }
 
+  dropLocals(stackFrame);
+
   if (trace.getNumberOfStackFrames() > 0) {
     MemoryTrace::StackFrameEntry sfe = trace.popFrame();
 
@@ -592,6 +1379,8 @@ void MemoryState::registerPopFrame(std::size_t stackFrame,
     // We need to clear the trace to prevent mixing stack frames
     trace.clear();
     fingerprint.discardEverything();
+    staleObjects = {};
+    startFingerprintEpoch();
 
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "no stackframe left in trace\n";
@@ -5,10 +5,16 @@
 #include "MemoryFingerprint.h"
 #include "MemoryTrace.h"
 
+#include "klee/ADT/ImmutableMap.h"
+#include "klee/ADT/ImmutableSet.h"
 #include "klee/Support/InfiniteLoopDetectionFlags.h"
 
+#include "llvm/ADT/DenseMap.h"
+
 #include <cstdint>
 #include <functional>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -38,49 +44,199 @@ private:
   bool disableMemoryState = true;
   bool globalDisableMemoryState = true;
 
-  const llvm::Function *shadowedFunction = nullptr;
-  std::size_t shadowedStackFrame = 0;
-  std::function<void(MemoryState &)> shadowCallback;
+  // Identifies the point since which all changes to memory have been
+  // registered (the fingerprint is discarded or writes are not registered
+  // otherwise). Fingerprints of different states are only comparable if
+  // they are relative to the same point, i.e. have the same epoch.
+  std::uint64_t fingerprintEpoch = 0;
+  static std::uint64_t nextFingerprintEpoch;
+
+  // Shadowed functions are not analyzed. As they may call other shadowed
+  // functions (e.g. memcpy within a library function), they are kept on a
+  // stack with the innermost one last.
+  struct ShadowFrame {
+    const llvm::Function *function;
+    std::size_t stackFrame;
+    // called after leaving the shadowed function
+    std::function<void(MemoryState &)> callback;
+    // whether changes to global memory are registered, i.e. this and all
+    // enclosing shadowed functions have been entered with registerGlobals
+    bool registerGlobals;
+  };
+  std::vector<ShadowFrame> shadowStack;
   bool registerGlobalsInShadow = false;
 
+  // Whether the memory trace is kept during the current external function
+  // call as its effects are known (FC_PURE or FC_ARGMEM), and the objects it
+  // is expected to modify. Both are reset on every external function call.
+  bool externalCallModeled = false;
+  std::vector<const MemoryObject *> externalWriteTargets;
+
+  // Feasible range [begin, end) of bytes written by the last write with a
+  // symbolic offset of each instruction, see setSymbolicWriteRange(). As
+  // constraints only grow, ranges remain valid in forked states (but not in
+  // merged ones, see registerMerge()).
+  struct SymbolicWriteRange {
+    ref<Expr> offset;
+    std::uint64_t begin;
+    std::uint64_t end;
+  };
+  ImmutableMap<const KInstruction *, SymbolicWriteRange> symbolicWriteRanges;
+
+  // ObjectStates whose bytes outside of [freshBegin, freshEnd) still
+  // contribute their value before a write with a restricted symbolic offset
+  // (see setSymbolicWriteRange()), as found in snapshot. These contributions
+  // are replaced by the current ones before any of these bytes is
+  // unregistered, see refreshStaleBytes().
+  struct StaleObject {
+    ref<ObjectState> snapshot;
+    std::uint64_t freshBegin;
+    std::uint64_t freshEnd;
+  };
+  ImmutableMap<const MemoryObject *, StaleObject> staleObjects;
+
+  // Objects whose changes are ignored in this state
+  // (klee_exclude_from_memory_state()), in addition to the write-only globals
+  // marked with MemoryObject::isExcludedFromFingerprint. Entries are removed
+  // when their object is freed or its stack frame is left.
+  ImmutableSet<const MemoryObject *> excludedObjects;
+
+  // Byte ranges of ObjectStates whose contributions have been removed from
+  // the fingerprint but not yet added again with their current value
+  // (-infinite-loop-detection-lazy-writes). Ranges are sorted and disjoint.
+  // They are added to the fingerprint by materializeDirtyWrites() before it
+  // is used, so that multiple writes to the same bytes are only hashed once.
+  struct DirtyObject {
+    ref<const MemoryObject> mo;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ranges;
+  };
+  llvm::DenseMap<const MemoryObject *, DirtyObject> dirtyObjects;
+
+  // -infinite-loop-detection-max-loop-iterations: number of iterations of
+  // the loops of each stack frame (outermost first), as pairs of loop header
+  // id and count. Counts are removed when their loop (or irreducible cycle)
+  // or stack frame is left and reset when an input function is called.
+  std::vector<std::vector<std::pair<unsigned, std::uint64_t>>> loopIterations;
+
   static KModule *kmodule;
-  static std::vector<llvm::Function *> outputFunctionsWhitelist;
-  static std::vector<llvm::Function *> inputFunctionsBlacklist;
-  static std::vector<llvm::Function *> libraryFunctionsList;
-  static std::vector<llvm::Function *> memoryFunctionsList;
 
-  template <std::size_t array_size>
-  static void initializeFunctionList(KModule *kmodule,
-                                     const char *(&functions)[array_size],
-                                     std::vector<llvm::Function *> &list);
+  // Classes of declared functions, as there are no KFunctions for them
+  // (defined functions are classified in KFunction::functionClass).
+  static std::unordered_map<const llvm::Function *, std::uint8_t>
+      declarationClasses;
+  static std::size_t numClassifiedFunctions;
+
+  static void classifyFunctions(KModule *kmodule,
+                                const std::vector<std::string> &functions,
+                                std::uint8_t functionClass);
+  static std::uint8_t getFunctionClass(const llvm::Function *f,
+                                       const KFunction *kf);
 
   static std::string ExprString(ref<Expr> expr);
 
+  void startFingerprintEpoch() { fingerprintEpoch = ++nextFingerprintEpoch; }
+
   void enterShadowFunction(const llvm::Function *f, std::size_t stackFrame,
                            std::function<void(MemoryState &)> &&callback = {},
                            bool registerGlobals = false);
   void leaveShadowFunction(const llvm::Function *f, std::size_t stackFrame);
+  // Only the stack frame of the outermost shadowed function is pushed to (and
+  // popped from) the memory trace.
+  bool isOutermostShadowedStackFrame(std::size_t stackFrame) const {
+    return !shadowStack.empty() && shadowStack.front().stackFrame == stackFrame;
+  }
 
-  KInstruction *getKInstruction(const llvm::BasicBlock *bb) const;
-  KFunction *getKFunction(const llvm::BasicBlock *bb) const;
   ref<Expr> getArgumentValue(const KFunction *kf, unsigned index) const;
   ref<Expr> getLocalValue(const KInstruction *kinst) const;
 
+  bool getWriteTarget(const MemoryObject &mo, bool &isLocal,
+                      MemoryFingerprint::fingerprint_t *&externalDelta);
   void applyWriteFragment(ref<Expr> address, const MemoryObject &mo,
-                          const ObjectState &os, std::size_t bytes);
+                          const ObjectState &os, std::size_t bytes,
+                          bool registration);
+  void applyWriteRange(const MemoryObject &mo, const ObjectState &os,
+                       std::uint64_t begin, std::uint64_t end, bool isLocal,
+                       MemoryFingerprint::fingerprint_t *externalDelta);
+  void refreshStaleBytes(const MemoryObject &mo, const ObjectState &os,
+                         std::uint64_t begin, std::uint64_t end, bool isLocal,
+                         MemoryFingerprint::fingerprint_t *externalDelta);
+  void dropLocals(std::size_t stackFrame);
+  void markDirty(const MemoryObject &mo, const ObjectState &os,
+                 std::uint64_t begin, std::uint64_t end, bool registration,
+                 bool isLocal, MemoryFingerprint::fingerprint_t *externalDelta);
+  void materializeDirtyWrites();
+  const SymbolicWriteRange *getSymbolicWriteRange(ref<Expr> offset) const;
+  void hashChunk(const ObjectState &os, std::uint64_t baseAddress,
+                 std::uint64_t chunk, std::uint64_t chunkEnd);
+  void applyToFingerprint(bool isLocal,
+                          MemoryFingerprint::fingerprint_t *externalDelta);
+  void applyToFingerprint(bool isLocal,
+                          MemoryFingerprint::fingerprint_t *externalDelta,
+                          const MemoryFingerprint::fingerprint_t &delta);
+
+  MemoryFingerprint::fingerprint_t getBasicBlockFingerprint(const KFunction *kf,
+                                                            unsigned id);
+  const MemoryFingerprint::fingerprint_t &
+  getCallersFingerprint(std::size_t stackFrame);
+
+  void leaveLoopIterations(const KFunction *kf, unsigned depth);
+  void leaveIrreducibleCycles(const KFunction *kf, unsigned id);
 
   void updateDisableMemoryState() {
-    disableMemoryState = shadowedFunction || globalDisableMemoryState;
+    disableMemoryState = !shadowStack.empty() || globalDisableMemoryState;
+    registerGlobalsInShadow =
+        !shadowStack.empty() && shadowStack.back().registerGlobals;
 
     if (DebugInfiniteLoopDetection.isSet(STDERR_STATE)) {
       llvm::errs() << "MemoryState: updating disableMemoryState: "
-                   << "(shadowedFunction: " << !!shadowedFunction << " || "
+                   << "(shadowedFunctions: " << shadowStack.size() << " || "
                    << "globalDisable: " << globalDisableMemoryState << ") "
                    << "= " << disableMemoryState << "\n";
     }
   }
 
 public:
+  /// Classes of functions that are treated specially on a call. A function
+  /// can belong to multiple classes, in which case the first one (in the
+  /// order below) is used.
+  enum FunctionClass : std::uint8_t {
+    // blacklist: input functions, clear the memory trace
+    FC_INPUT = 1 << 0,
+    // whitelist: output functions, shadowed
+    FC_OUTPUT = 1 << 1,
+    // library functions that might use heavy loops that we do not want to
+    // inspect, shadowed but changes to global memory are registered
+    FC_LIBRARY = 1 << 2,
+    // library functions with signature (*dest, _, count) that modify the
+    // memory starting from dest for count bytes
+    FC_MEMORY = 1 << 3,
+    // external functions whose result only depends on their arguments and
+    // that do not modify memory (except for errno)
+    FC_PURE = 1 << 4,
+    // external functions whose result only depends on their arguments and
+    // the memory they point to, and that only modify that memory
+    FC_ARGMEM = 1 << 5
+  };
+
+  /// Names of the functions in each class, the built-in lists can be
+  /// extended or replaced by -infinite-loop-detection-function-lists.
+  struct FunctionLists {
+    std::vector<std::string> output;
+    std::vector<std::string> input;
+    std::vector<std::string> library;
+    std::vector<std::string> memory;
+    std::vector<std::string> pure;
+    std::vector<std::string> argmem;
+  };
+
+  /// Read function lists from a JSON or YAML file of the form
+  /// {"builtins": true, "output": [...], "input": [...], "library": [...],
+  /// "memory": [...], "pure": [...], "argmem": [...]}. Unless builtins is
+  /// false, the functions are added to the given lists, otherwise they
+  /// replace them. Exits on errors.
+  static void loadFunctionLists(const std::string &path,
+                                FunctionLists &lists);
+
   MemoryState() = delete;
   MemoryState &operator=(const MemoryState &) = delete;
 
@@ -90,7 +246,21 @@ public:
     executionState = state;
   }
 
+#ifdef KLEE_UNITTEST
+  // provide this function only in the context of unittests
+  MemoryFingerprint::fingerprint_t getFingerprint() {
+    materializeDirtyWrites();
+    return fingerprint.getFingerprint();
+  }
+
+  void registerBasicBlock(const KInstruction *inst,
+                          const MemoryFingerprint::fingerprint_t &fp) {
+    trace.registerBasicBlock(inst, fp);
+  }
+#endif
+
   void disable() {
+    materializeDirtyWrites();
     globalDisableMemoryState = true;
     updateDisableMemoryState();
   }
@@ -98,12 +268,18 @@ public:
   void enable() {
     globalDisableMemoryState = false;
     updateDisableMemoryState();
+    // writes have not been registered while disabled
+    startFingerprintEpoch();
   }
 
   static std::pair<std::size_t, std::size_t> getTraceStructSizes() {
     return MemoryTrace::getTraceStructSizes();
   }
 
+  static std::size_t getTraceIndexNodeSize() {
+    return MemoryTrace::getTraceIndexNodeSize();
+  }
+
   std::pair<std::size_t, std::size_t> getTraceLength() const {
     return trace.getTraceLength();
   }
@@ -116,28 +292,38 @@ public:
     return trace.getNumberOfEntriesInCurrentStackFrame();
   }
 
+  std::size_t getNumberOfRevisitsInCurrentStackFrame() const {
+    return trace.getNumberOfRevisitsInCurrentStackFrame();
+  }
+
   std::size_t getFunctionListsLength() const {
-    return MemoryState::outputFunctionsWhitelist.size() +
-           MemoryState::inputFunctionsBlacklist.size() +
-           MemoryState::libraryFunctionsList.size() +
-           MemoryState::memoryFunctionsList.size();
+    return MemoryState::numClassifiedFunctions;
   }
 
   std::size_t getFunctionListsCapacity() const {
-    return MemoryState::outputFunctionsWhitelist.capacity() +
-           MemoryState::inputFunctionsBlacklist.capacity() +
-           MemoryState::libraryFunctionsList.capacity() +
-           MemoryState::memoryFunctionsList.capacity();
+    return MemoryState::numClassifiedFunctions +
+           MemoryState::declarationClasses.bucket_count();
   }
 
+  /// Classify the functions of kmodule (has to be called before any
+  /// function call is registered).
   static void setKModule(KModule *kmodule);
 
-  void registerFunctionCall(const llvm::Function *f, std::size_t stackFrame,
+  /// kf is the KFunction of f if f is defined in the module (nullptr
+  /// otherwise).
+  void registerFunctionCall(const llvm::Function *f, const KFunction *kf,
+                            std::size_t stackFrame,
                             std::vector<ref<Expr>> &arguments);
   void registerFunctionRet(const llvm::Function *f, std::size_t stackFrame);
 
   void clearEverything();
 
+  /// Called after the ExecutionState has been merged with another one, whose
+  /// differing bytes have been (un)registered as writes. The memory trace is
+  /// cleared, as the merged state has not been on the path it records, and
+  /// so are the ranges of symbolic offsets, as its constraints are weaker.
+  void registerMerge();
+
   void registerWrite(ref<Expr> address, const MemoryObject &mo,
                      const ObjectState &os, std::size_t bytes);
   void registerWrite(ref<Expr> address, const MemoryObject &mo,
@@ -154,13 +340,76 @@ public:
     unregisterWrite(mo.getBaseExpr(), mo, os, os.size);
   }
 
-  void registerExternalFunctionCall();
+  /// Remove the contribution of mo from the fingerprint and ignore all
+  /// further changes to it in this state (and the states forked from it).
+  void excludeFromFingerprint(const MemoryObject &mo, const ObjectState &os);
+
+  /// Remove the contribution of mo from the fingerprint before it is
+  /// unbound by free() or realloc().
+  void registerFree(const MemoryObject &mo, const ObjectState &os);
+
+  /// Register a call to the external function f with pointers to the given
+  /// objects as arguments. Unless the effects of f are known (FC_PURE or
+  /// FC_ARGMEM), the memory trace is cleared.
+  void registerExternalFunctionCall(
+      const llvm::Function *f, std::vector<const MemoryObject *> &&arguments);
+  /// Rehash an object modified by the current external function call, with
+  /// its ObjectState before (modified = false) and after the modification
+  /// (see AddressSpace::copyInConcretes()). Unless expected is set, clears
+  /// the memory trace if the object is not among the objects that the
+  /// function may modify according to its class.
+  void registerExternalWrite(const MemoryObject &mo, const ObjectState &os,
+                             bool modified, bool expected = false);
+
+  /// Restrict (un)registering writes with the given symbolic offset by the
+  /// current instruction to the bytes [begin, end) of the ObjectState.
+  /// A write with a symbolic offset extends the update list of the whole
+  /// ObjectState, so the expressions of bytes outside of this range change
+  /// without being rehashed. Their values do not change, but their stale
+  /// contributions can no longer be removed by hashing the current
+  /// expressions. Therefore, a snapshot of the ObjectState before the write
+  /// is kept until these bytes are unregistered again.
+  void setSymbolicWriteRange(ref<Expr> offset, std::uint64_t begin,
+                             std::uint64_t end);
+  bool hasSymbolicWriteRange(ref<Expr> offset) const {
+    return getSymbolicWriteRange(offset) != nullptr;
+  }
 
-  void registerBasicBlock(const llvm::BasicBlock &bb);
+  /// Register the basic block with the given id (see KFunction::basicBlocks)
+  /// in the memory trace.
+  void registerBasicBlock(const KFunction *kf, unsigned id);
+
+  /// Compute a fingerprint of the whole state at the first instruction of
+  /// the basic block with the given id of kf (in the current stack frame):
+  /// memory, live locals, locals of the calling stack frames and the call
+  /// stack. Returns false if the memory state is disabled. Fingerprints of
+  /// different states are equal only if their memory states are (up to
+  /// dead locals, unless the hash collides).
+  bool getStateFingerprint(const KFunction *kf, unsigned id,
+                           MemoryFingerprint::fingerprint_t &result);
+
+  /// Update the loop scopes of the memory trace and the iteration counts of
+  /// left loops on the control flow transition between the basic blocks
+  /// with ids src and dst of kf.
+  void registerLoopTransition(const KFunction *kf, unsigned src,
+                              unsigned dst);
+
+  /// Count an iteration of the loop with header id in the current stack
+  /// frame and return the number of its iterations since it has been entered
+  /// or an input function has been called (0 if disabled).
+  std::uint64_t registerLoopIteration(unsigned id);
 
   bool findInfiniteLoopInFunction() const;
   bool findInfiniteRecursion() const;
 
+  std::size_t getInfiniteLoopPeriod() const {
+    return trace.getInfiniteLoopPeriod();
+  }
+
+  std::size_t getInfiniteRecursionPeriod() const {
+    return trace.getInfiniteRecursionPeriod();
+  }
+
   void registerPushFrame(const llvm::Function *function,
                          std::size_t stackFrame);
   void registerPopFrame(std::size_t stackFrame,
@@ -1,5 +1,6 @@
 #include "MemoryTrace.h"
 
+#include "CoreStats.h"
 #include "ExecutionState.h"
 #include "MemoryFingerprint.h"
 
@@ -11,9 +12,12 @@
 #include "llvm/IR/Function.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstdint>
 #include <iomanip>
 #include <iterator>
+#include <limits>
 #include <sstream>
+#include <unordered_map>
 
 /*
 
@@ -30,8 +34,8 @@
    9. registerBasicBlock(inst 7, fingerprint 7);
 
 
-   std::vector<MemoryTraceEntry>
-              trace
+     MemoryTraceEntries
+   (logical view of trace)
 
  #     inst      fingerprint                      std::vector<StackFrameEntry>
    +---------+----------------+                            stackFrames
@@ -50,24 +54,496 @@
  0 | inst 1  | fingerprint 1  |   /
    +---------+----------------+--+
 
+   In addition, every stack frame has an index (indices) that contains the
+   first occurrence of every distinct (inst, fingerprint) within the stack
+   frame, such that findInfiniteLoopInFunction() does not need to scan the
+   whole stack frame.
+
+   Entries are not stored in a single vector but in a list of chunks that is
+   shared between forked states, e.g. after a fork that follows inst 5 and one
+   more basic block in each state:
+
+       state A:  head --> [ inst 6' ] --+
+                                        +--> [ inst 4, 5 ] --> [ inst 1, 2, 3 ]
+       state B:  head --> [ inst 6" ] --+      offset 3          offset 0
+
+   Each state only sees the entries below its own traceSize. A chunk is
+   appended to in place only while it is referenced by a single state,
+   otherwise a new chunk is started. Together with the persistent indices,
+   copying a MemoryTrace is linear in the number of stack frames instead of
+   the number of entries.
+
+   With -infinite-loop-detection-max-frame-entries=n, the current stack frame
+   is rebuilt as soon as it contains n entries. Its first entry (stack frame
+   base) and the newest n/2 entries are retained; with
+   -infinite-loop-detection-eviction=sampling, the entries at the largest
+   (n/2 - 1)/2 offsets below the retained window that are powers of two
+   (relative to the stack frame) are retained as well, similar to the
+   checkpoints of Brent's cycle detection algorithm. At most about 3n/4
+   entries are left, so the next eviction happens after about n/4 further
+   entries. Eviction never introduces false positives, but only loops with a
+   period of at most n/2 registered basic blocks are guaranteed to be detected
+   immediately. With sampling (and n >= 4), a loop with period p that starts
+   after m entries is still detected once it repeats the largest checkpoint
+   >= max(m, p), i.e. after at most 2 * max(m + 1, p) + p entries.
+
+   With -infinite-loop-detection-algorithm=brent, no entries are stored at
+   all. Instead, every stack frame keeps its base and a checkpoint that every
+   new entry is compared to. The checkpoint is moved to the newest entry after
+   1, 2, 4, ... steps (Brent's cycle detection algorithm), such that a loop
+   with period p that starts after m entries is detected after at most
+   2 * max(m + 1, p) + p entries, with constant memory per stack frame.
+
+   With -infinite-loop-detection-truncate-loops, the state of the current
+   stack frame (trace size and index) is saved whenever a loop is entered and
+   restored once it is left again. Entries registered within a loop can only
+   match entries of the same loop, whereas an infinite loop that repeatedly
+   enters and leaves an inner loop still repeats an entry of the outer loop.
+   Thus, the trace only grows with the current loop nest.
+
+   With -infinite-loop-detection-compact-trace, chunks do not store
+   MemoryTraceEntries but two arrays of 32-bit ids (instructions and
+   fingerprints are interned in global tables), and the index of each stack
+   frame maps the resulting 64-bit keys to the position of their first
+   occurrence.
+
 */
 
 namespace klee {
 
+namespace {
+// Global tables that intern instructions and fingerprints for the compact
+// trace layout. Interned values are never removed.
+template <typename T, typename Hash = std::hash<T>> class InternTable {
+  std::unordered_map<T, std::uint32_t, Hash> ids;
+  // points to keys of ids (which are not moved on rehashing)
+  std::vector<const T *> values;
+
+public:
+  std::uint32_t intern(const T &value) {
+    auto result = ids.emplace(value, static_cast<std::uint32_t>(values.size()));
+    if (result.second) {
+      assert(values.size() < std::numeric_limits<std::uint32_t>::max() &&
+             "too many distinct values to intern");
+      values.push_back(&result.first->first);
+    }
+    return result.first->second;
+  }
+
+  const T &get(std::uint32_t id) const { return *values[id]; }
+};
+
+struct FingerprintHash {
+  std::size_t operator()(const MemoryFingerprint::fingerprint_t &fp) const {
+    return MemoryFingerprint::hash(fp);
+  }
+};
+
+InternTable<const KInstruction *> instructionTable;
+InternTable<MemoryFingerprint::fingerprint_t, FingerprintHash> fingerprintTable;
+} // namespace
+
+MemoryTrace::TraceChunk::TraceChunk(ref<TraceChunk> previous,
+                                    std::size_t offset, std::size_t capacity)
+    : previous(std::move(previous)), offset(offset) {
+  if (InfiniteLoopDetectionCompactTrace) {
+    instructionIds.reserve(capacity);
+    fingerprintIds.reserve(capacity);
+  } else {
+    entries.reserve(capacity);
+  }
+}
+
+MemoryTrace::TraceChunk::~TraceChunk() {
+  // release exclusively owned predecessors iteratively, as long chains of
+  // chunks would otherwise be destroyed recursively
+  ref<TraceChunk> chunk = std::move(previous);
+  while (!chunk.isNull() && chunk->_refCount.getCount() == 1) {
+    ref<TraceChunk> next = std::move(chunk->previous);
+    chunk = std::move(next);
+  }
+}
+
+std::size_t MemoryTrace::TraceChunk::size() const {
+  if (InfiniteLoopDetectionCompactTrace)
+    return fingerprintIds.size();
+  return entries.size();
+}
+
+std::size_t MemoryTrace::TraceChunk::capacity() const {
+  if (InfiniteLoopDetectionCompactTrace)
+    return fingerprintIds.capacity();
+  return entries.capacity();
+}
+
+void MemoryTrace::TraceChunk::erase(std::size_t position) {
+  if (position >= size())
+    return;
+  if (InfiniteLoopDetectionCompactTrace) {
+    instructionIds.erase(instructionIds.begin() + position,
+                         instructionIds.end());
+    fingerprintIds.erase(fingerprintIds.begin() + position,
+                         fingerprintIds.end());
+  } else {
+    entries.erase(entries.begin() + position, entries.end());
+  }
+}
+
+const KInstruction *
+MemoryTrace::TraceChunk::getInstruction(std::size_t position) const {
+  if (InfiniteLoopDetectionCompactTrace)
+    return instructionTable.get(instructionIds[position]);
+  return entries[position].inst;
+}
+
+const MemoryTrace::fingerprint_t &
+MemoryTrace::TraceChunk::getFingerprint(std::size_t position) const {
+  if (InfiniteLoopDetectionCompactTrace)
+    return fingerprintTable.get(fingerprintIds[position]);
+  return entries[position].fingerprint;
+}
+
+MemoryTrace::compact_entry_t
+MemoryTrace::TraceChunk::getCompactEntry(std::size_t position) const {
+  return (static_cast<compact_entry_t>(instructionIds[position]) << 32) |
+         fingerprintIds[position];
+}
+
+std::pair<std::size_t, std::size_t> MemoryTrace::getTraceStructSizes() {
+  std::size_t entrySize = sizeof(MemoryTraceEntry);
+  if (InfiniteLoopDetectionCompactTrace)
+    entrySize = 2 * sizeof(std::uint32_t);
+  return std::make_pair(entrySize, sizeof(StackFrameEntry));
+}
+
+std::size_t MemoryTrace::getTraceIndexNodeSize() {
+  if (InfiniteLoopDetectionCompactTrace)
+    return compact_index_t::getNodeSize();
+  return index_t::getNodeSize();
+}
+
+bool MemoryTrace::isHeadAppendable() {
+  if (head.isNull() || head->_refCount.getCount() != 1)
+    return false;
+
+  // no other MemoryTrace can see entries beyond traceSize
+  head->erase(traceSize - head->offset);
+  return head->size() < head->capacity();
+}
+
+void MemoryTrace::startChunk() {
+  // head is either full or shared with another MemoryTrace
+  std::size_t capacity = minChunkCapacity;
+  if (!head.isNull() && head->_refCount.getCount() == 1) {
+    capacity = 2 * head->capacity();
+    if (capacity > maxChunkCapacity)
+      capacity = maxChunkCapacity;
+  }
+  head = new TraceChunk(head, traceSize, capacity);
+}
+
+const MemoryTrace::MemoryTraceEntry &
+MemoryTrace::appendEntry(const KInstruction *instruction,
+                         const fingerprint_t &fingerprint) {
+  if (!isHeadAppendable())
+    startChunk();
+
+  head->entries.emplace_back(instruction, fingerprint);
+  ++traceSize;
+  return head->entries.back();
+}
+
+void MemoryTrace::appendCompactEntry(compact_entry_t key) {
+  if (!isHeadAppendable())
+    startChunk();
+
+  head->instructionIds.push_back(static_cast<std::uint32_t>(key >> 32));
+  head->fingerprintIds.push_back(static_cast<std::uint32_t>(key));
+  ++traceSize;
+}
+
+void MemoryTrace::truncate(std::size_t size) {
+  assert(size <= traceSize);
+  traceSize = size;
+  // drop chunks without visible entries
+  while (!head.isNull() && head->offset >= traceSize) {
+    head = head->previous;
+  }
+}
+
 void MemoryTrace::registerBasicBlock(const KInstruction *instruction,
                                      const fingerprint_t &fingerprint) {
-  trace.emplace_back(instruction, fingerprint);
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT) {
+    // entries are only counted, but not stored
+    ++traceSize;
+    ++indices.back().registered;
+    updateBrentState(MemoryTraceEntry(instruction, fingerprint));
+    return;
+  }
+
+  std::size_t maxEntries = InfiniteLoopDetectionMaxFrameEntries;
+  if (maxEntries > 0 && getNumberOfEntriesInCurrentStackFrame() >= maxEntries)
+    evictEntries();
+
+  ++indices.back().registered;
+  appendToCurrentStackFrame(instruction, fingerprint);
+}
+
+void MemoryTrace::updateBrentState(const MemoryTraceEntry &entry) {
+  BrentState &current = brentStates.back();
+
+  if (getNumberOfEntriesInCurrentStackFrame() == 1) {
+    current = BrentState();
+    current.base = entry;
+    current.checkpoint = entry;
+    return;
+  }
+
+  ++current.steps;
+  if (entry == current.checkpoint) {
+    current.period = current.steps;
+    return;
+  }
+  current.period = 0;
+
+  // move checkpoint after 1, 2, 4, ... steps, such that it eventually lies
+  // within a cycle and the cycle is shorter than the distance to the next
+  // move of the checkpoint
+  if (current.steps == current.power) {
+    current.checkpoint = entry;
+    current.power *= 2;
+    current.steps = 0;
+  }
+}
+
+void MemoryTrace::appendToCurrentStackFrame(const KInstruction *instruction,
+                                            const fingerprint_t &fingerprint) {
+  StackFrameIndex &current = indices.back();
+
+  if (InfiniteLoopDetectionCompactTrace) {
+    compact_entry_t key =
+        (static_cast<compact_entry_t>(instructionTable.intern(instruction))
+         << 32) |
+        fingerprintTable.intern(fingerprint);
+    appendCompactEntry(key);
+
+    if (getNumberOfEntriesInCurrentStackFrame() == 1)
+      current.compactBase = key;
+
+    auto it = current.compactIndex.lower_bound(key);
+    auto end = current.compactIndex.end();
+    if (it != end && it->first == key)
+      return;
+    // keys of the same instruction are adjacent
+    bool revisit = it != end && (it->first >> 32) == (key >> 32);
+    if (!revisit) {
+      --it;
+      revisit = it != end && (it->first >> 32) == (key >> 32);
+    }
+    if (revisit)
+      ++current.revisits;
+    current.compactIndex =
+        current.compactIndex.insert(std::make_pair(key, traceSize - 1));
+    return;
+  }
+
+  const MemoryTraceEntry &entry = appendEntry(instruction, fingerprint);
+
+  if (getNumberOfEntriesInCurrentStackFrame() == 1)
+    current.base = &entry;
+
+  // entries that are already part of the index do not need to be added again,
+  // as every later match would also match the earlier occurrence
+  auto it = current.index.lower_bound(&entry);
+  auto end = current.index.end();
+  if (it != end && *it->first == entry)
+    return;
+  // entries of the same instruction are adjacent
+  bool revisit = it != end && it->first->inst == instruction;
+  if (!revisit) {
+    --it;
+    revisit = it != end && it->first->inst == instruction;
+  }
+  if (revisit)
+    ++current.revisits;
+  current.index = current.index.insert(std::make_pair(&entry, traceSize - 1));
+}
+
+void MemoryTrace::getEvictionBudget(std::size_t &window,
+                                    std::size_t &maxCheckpoints) {
+  // After an eviction, at most 1 + window + maxCheckpoints < n entries are
+  // left (for n > 3), i.e. about 3n/4, so that at least about n/4 entries are
+  // registered before the next eviction copies the retained ones again.
+  std::size_t budget = InfiniteLoopDetectionMaxFrameEntries;
+  window = std::max<std::size_t>(1, budget / 2);
+  maxCheckpoints = 0;
+  if (InfiniteLoopDetectionEviction == EVICT_SAMPLING && budget > window + 1)
+    maxCheckpoints = (budget - window - 1) / 2;
+}
+
+std::size_t MemoryTrace::getMinCheckpoint(std::size_t windowStart,
+                                          std::size_t maxCheckpoints) {
+  if (maxCheckpoints == 0 || windowStart <= 1)
+    return windowStart;
+  // the largest maxCheckpoints powers of two below windowStart
+  std::size_t checkpoint = 1;
+  while (checkpoint * 2 < windowStart)
+    checkpoint *= 2;
+  for (std::size_t i = 1; i < maxCheckpoints && checkpoint > 1; ++i)
+    checkpoint /= 2;
+  return checkpoint;
+}
+
+void MemoryTrace::getRetainedOffsets(const StackFrameIndex &frame,
+                                     std::size_t numEntries,
+                                     std::vector<std::size_t> &offsets) {
+  offsets.clear();
+  offsets.reserve(numEntries);
+  if (frame.windowStart == 0) {
+    for (std::size_t offset = 0; offset < numEntries; ++offset)
+      offsets.push_back(offset);
+    return;
+  }
+
+  std::size_t window, maxCheckpoints;
+  getEvictionBudget(window, maxCheckpoints);
+  offsets.push_back(0);
+  for (std::size_t offset =
+           getMinCheckpoint(frame.windowStart, maxCheckpoints);
+       offset < frame.windowStart; offset *= 2)
+    offsets.push_back(offset);
+  for (std::size_t offset = frame.windowStart; offset < frame.registered;
+       ++offset)
+    offsets.push_back(offset);
+  assert(offsets.size() == numEntries && "inconsistent eviction state");
+}
+
+std::size_t MemoryTrace::getRegisteredOffset(const StackFrameIndex &frame,
+                                             std::size_t position) {
+  if (frame.windowStart == 0 || position == 0)
+    return position;
+
+  // same layout as reconstructed by getRetainedOffsets()
+  std::size_t window, maxCheckpoints;
+  getEvictionBudget(window, maxCheckpoints);
+  std::size_t checkpoint = getMinCheckpoint(frame.windowStart, maxCheckpoints);
+  std::size_t checkpoints = 0;
+  for (std::size_t offset = checkpoint; offset < frame.windowStart; offset *= 2)
+    ++checkpoints;
+  if (position <= checkpoints)
+    return checkpoint << (position - 1);
+  return frame.windowStart + (position - 1 - checkpoints);
+}
+
+void MemoryTrace::evictEntries() {
+  StackFrameIndex &current = indices.back();
+  std::size_t numEntries = getNumberOfEntriesInCurrentStackFrame();
+  std::size_t frameStart = traceSize - numEntries;
+
+  // offsets (relative to the stack frame) of all entries that are currently
+  // retained, following from the previous eviction
+  std::vector<std::size_t> offsets;
+  getRetainedOffsets(current, numEntries, offsets);
+
+  // keep the newest window and the largest checkpoints below it
+  std::size_t window, maxCheckpoints;
+  getEvictionBudget(window, maxCheckpoints);
+  std::size_t windowStart = current.registered - window;
+  std::size_t minCheckpoint = getMinCheckpoint(windowStart, maxCheckpoints);
+
+  // copy entries of the current stack frame that are retained
+  std::vector<std::pair<const KInstruction *, fingerprint_t>> retained;
+  std::size_t end = traceSize;
+  for (const TraceChunk *chunk = head.get(); end > frameStart;
+       chunk = chunk->previous.get()) {
+    std::size_t begin = chunk->offset > frameStart ? chunk->offset : frameStart;
+    for (std::size_t i = end; i-- > begin;) {
+      std::size_t offset = offsets[i - frameStart];
+      bool isCheckpoint =
+          offset >= minCheckpoint && (offset & (offset - 1)) == 0;
+      if (offset == 0 || isCheckpoint || offset >= windowStart) {
+        retained.emplace_back(chunk->getInstruction(i - chunk->offset),
+                              chunk->getFingerprint(i - chunk->offset));
+      }
+    }
+    end = begin;
+  }
+
+  // rebuild stack frame from scratch, chunks that are not shared with other
+  // states are released by truncate()
+  truncate(frameStart);
+  current.index = index_t();
+  current.compactIndex = compact_index_t();
+  current.base = nullptr;
+  current.windowStart = windowStart;
+  std::size_t revisits = current.revisits;
+  for (auto it = retained.rbegin(); it != retained.rend(); ++it)
+    appendToCurrentStackFrame(it->first, it->second);
+  // revisits are counted over all registered entries
+  current.revisits = revisits;
+
+  ++stats::traceEvictions;
+  stats::traceEvictedEntries += numEntries - retained.size();
+
+  if (DebugInfiniteLoopDetection.isSet(STDERR_TRACE)) {
+    llvm::errs() << "Evicted " << (numEntries - retained.size())
+                 << " entries from current StackFrame\n";
+    dumpTrace();
+  }
 }
 
 void MemoryTrace::registerEndOfStackFrame(
     const llvm::Function *function, fingerprint_t fingerprintLocalDelta,
     fingerprint_t fingerprintAllocaDelta) {
 
-  assert((stackFrames.empty() || trace.size() != stackFrames.back().index) &&
+  assert((stackFrames.empty() || traceSize != stackFrames.back().index) &&
          "cannot have two entries with same index");
 
-  stackFrames.emplace_back(trace.size(), function, fingerprintLocalDelta,
+  stackFrames.emplace_back(traceSize, function, fingerprintLocalDelta,
                            fingerprintAllocaDelta);
+  indices.emplace_back();
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT)
+    brentStates.emplace_back();
+}
+
+void MemoryTrace::enterLoop(unsigned depth) {
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT)
+    return;
+
+  loopScopes.push_back(
+      {indices.size() - 1, depth, traceSize, indices.back()});
+}
+
+void MemoryTrace::leaveLoops(unsigned depth) {
+  std::size_t frame = indices.size() - 1;
+  if (loopScopes.empty() || loopScopes.back().frame != frame ||
+      loopScopes.back().depth <= depth)
+    return;
+
+  // find outermost loop scope that has been left
+  auto it = loopScopes.end() - 1;
+  while (it != loopScopes.begin() && (it - 1)->frame == frame &&
+         (it - 1)->depth > depth)
+    --it;
+  LoopScope scope = std::move(*it);
+  loopScopes.erase(it, loopScopes.end());
+
+  StackFrameIndex &current = indices.back();
+  std::size_t frameStart = traceSize - getNumberOfEntriesInCurrentStackFrame();
+  // Entries might have been evicted in the meantime, which rebuilds the stack
+  // frame. In addition, the stack frame base is always retained.
+  if (current.windowStart != scope.index.windowStart ||
+      scope.traceSize <= frameStart)
+    return;
+
+  stats::traceTruncatedEntries += traceSize - scope.traceSize;
+  truncate(scope.traceSize);
+  current = std::move(scope.index);
+
+  if (DebugInfiniteLoopDetection.isSet(STDERR_TRACE)) {
+    llvm::errs() << "Leaving loops deeper than " << depth << "\n";
+    dumpTrace();
+  }
 }
 
 void MemoryTrace::clear() {
@@ -75,8 +551,12 @@ void MemoryTrace::clear() {
     dumpTrace();
   }
 
-  trace.clear();
+  truncate(0);
   stackFrames.clear();
+  loopScopes.clear();
+  indices.assign(1, {});
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT)
+    brentStates.assign(1, {});
 
   if (DebugInfiniteLoopDetection.isSet(STDERR_TRACE)) {
     dumpTrace();
@@ -98,13 +578,18 @@ MemoryTrace::StackFrameEntry MemoryTrace::popFrame() {
 
   // delete all PCs and fingerprints of BasicBlocks
   // that are part of current stack frame
-  std::size_t index = sfe.index;
-  trace.erase(trace.begin() + index, trace.end());
+  // (chunks shared with other states remain unmodified)
+  truncate(sfe.index);
   // there is no need to modify the indices in
   // stackFrames because lower indices stay the same
 
   // remove topmost stack frame
+  while (!loopScopes.empty() && loopScopes.back().frame == indices.size() - 1)
+    loopScopes.pop_back();
   stackFrames.pop_back();
+  indices.pop_back();
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT)
+    brentStates.pop_back();
 
   if (DebugInfiniteLoopDetection.isSet(STDERR_TRACE)) {
     llvm::errs() << "Popping StackFrame\n";
@@ -114,35 +599,59 @@ MemoryTrace::StackFrameEntry MemoryTrace::popFrame() {
   return sfe;
 }
 
+std::size_t MemoryTrace::getInfiniteLoopPeriod() const {
+  if (getNumberOfEntriesInCurrentStackFrame() < 2)
+    return 0;
+
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT)
+    return brentStates.back().period;
+
+  // the index of the current stack frame contains an entry with same PC and
+  // fingerprint iff the topmost entry is not the first of its kind
+  std::size_t frameStart = traceSize - getNumberOfEntriesInCurrentStackFrame();
+  std::size_t top = traceSize - 1;
+  std::size_t first;
+  if (InfiniteLoopDetectionCompactTrace) {
+    compact_entry_t key = head->getCompactEntry(top - head->offset);
+    first = indices.back().compactIndex.lookup(key)->second;
+  } else {
+    const MemoryTraceEntry &entry = head->entries[top - head->offset];
+    first = indices.back().index.lookup(&entry)->second;
+  }
+  // entries might have been evicted in between, so count registered entries
+  // instead of trace positions
+  const StackFrameIndex &current = indices.back();
+  assert(getRegisteredOffset(current, top - frameStart) ==
+             current.registered - 1 &&
+         "topmost entry has not been retained");
+  return current.registered - 1 -
+         getRegisteredOffset(current, first - frameStart);
+}
+
 bool MemoryTrace::findInfiniteLoopInFunction() const {
   if (stackFrames.size() > 0) {
     // current stack frame has always at least one basic block
-    assert(stackFrames.back().index < trace.size() &&
+    assert(stackFrames.back().index < traceSize &&
            "current stack frame is empty");
   }
 
-  std::size_t topStackFrameEntries = getNumberOfEntriesInCurrentStackFrame();
-
   // find matching entries within first stack frame
-  if (topStackFrameEntries > 1) {
-    const MemoryTraceEntry &topEntry = trace.back();
-    auto it = trace.rbegin() + 1; // skip first element
-    for (; it != trace.rbegin() + topStackFrameEntries; ++it) {
-      // iterate over all elements within the first stack frame (but the first)
-      if (topEntry == *it) {
-        // found an entry with same PC and fingerprint
-        return true;
-      }
-    }
-  }
-  return false;
+  return getInfiniteLoopPeriod() != 0;
 }
 
-bool MemoryTrace::findInfiniteRecursion() const {
+bool MemoryTrace::hasEqualStackFrameBase(std::size_t i, std::size_t j) const {
+  if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT)
+    return brentStates[i].base == brentStates[j].base;
+  if (InfiniteLoopDetectionCompactTrace)
+    return indices[i].compactBase == indices[j].compactBase;
+  return *indices[i].base == *indices[j].base;
+}
+
+std::size_t MemoryTrace::getInfiniteRecursionPeriod() const {
   if (stackFrames.empty())
-    return false;
+    return 0;
 
-  assert(stackFrames.back().index < trace.size() &&
+  assert(stackFrames.back().index < traceSize &&
          "a stack frame should always have at least one basic block entry");
 
   // To find infinite recursion, it suffices to find a match of the first
@@ -150,35 +659,39 @@ bool MemoryTrace::findInfiniteRecursion() const {
   // This entry is called stack frame base and only contains changes to global
   // memory objects, alloca deltas of previous stack frames and the binding
   // of arguments supplied to a function.
-  const MemoryTraceEntry &currentStackFrameBase =
-      trace.at(stackFrames.back().index);
+  // The base of the stack frame that starts at stackFrames[i].index is
+  // stored in indices[i + 1] (and brentStates[i + 1]).
+  std::size_t current = indices.size() - 1;
+  for (std::size_t distance = 1; distance < current; ++distance) {
+    if (hasEqualStackFrameBase(current - distance, current))
+      return distance;
+  }
+  return 0;
+}
 
-  return std::find_if(std::next(stackFrames.rbegin()), stackFrames.rend(),
-                      [&](const StackFrameEntry &sfe) {
-                        const MemoryTraceEntry &stackFrameBase =
-                            trace.at(sfe.index);
-                        return currentStackFrameBase == stackFrameBase;
-                      }) != stackFrames.rend();
+bool MemoryTrace::findInfiniteRecursion() const {
+  return getInfiniteRecursionPeriod() != 0;
 }
 
 bool MemoryTrace::isAllocaAllocationInCurrentStackFrame(
-    const ExecutionState &state, const MemoryObject &mo) {
-  return (state.stack.size() - 1 == mo.getStackframeIndex());
+    std::size_t stackSize, const MemoryObject &mo) {
+  // frames beyond stackSize are treated as part of the current stack frame
+  return (stackSize - 1 <= mo.getStackframeIndex());
 }
 
 MemoryTrace::fingerprint_t *
-MemoryTrace::getPreviousAllocaDelta(const ExecutionState &state,
+MemoryTrace::getPreviousAllocaDelta(std::size_t stackSize,
                                     const MemoryObject &mo) {
-  assert(!isAllocaAllocationInCurrentStackFrame(state, mo));
+  assert(!isAllocaAllocationInCurrentStackFrame(stackSize, mo));
 
   std::size_t index = mo.getStackframeIndex();
 
-  // Compared to stackFrames, state.stack contains at least one more stack
+  // Compared to stackFrames, the stack contains at least one more stack
   // frame, i.e. the currently executed one (top most entry)
-  assert(stackFrames.size() + 1 <= state.stack.size());
+  assert(stackFrames.size() + 1 <= stackSize);
 
   // smallest index that is present in MemoryTrace
-  std::size_t smallestIndex = state.stack.size() - (stackFrames.size() + 1);
+  std::size_t smallestIndex = stackSize - (stackFrames.size() + 1);
   if (index < smallestIndex) {
     // MemoryTrace has been cleared since the time of allocation
     return nullptr;
@@ -189,24 +702,54 @@ MemoryTrace::getPreviousAllocaDelta(const ExecutionState &state,
 }
 
 void MemoryTrace::dumpTrace(llvm::raw_ostream &out) const {
-  if (trace.empty()) {
+  if (traceSize == 0) {
     out << "MemoryTrace is empty\n";
+  } else if (InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT) {
+    out << "TOP OF MemoryTrace STACK (" << traceSize
+        << " registered, only checkpoints are stored)\n";
+    for (std::size_t i = brentStates.size(); i-- > 0;) {
+      const BrentState &bs = brentStates[i];
+      if (i + 1 < brentStates.size()) {
+        out << "STACKFRAME BOUNDARY " << (i + 1) << "/" << stackFrames.size()
+            << "\n";
+      }
+      for (const MemoryTraceEntry *entry : {&bs.checkpoint, &bs.base}) {
+        if (entry->inst == nullptr)
+          continue;
+        const InstructionInfo &ii = *entry->inst->info;
+        out << (entry == &bs.base ? "base " : "checkpoint ") << entry->inst
+            << " (" << ii.file << ":" << ii.line << ":" << ii.id
+            << "): " << MemoryFingerprint::toString(entry->fingerprint);
+        if (entry == &bs.checkpoint) {
+          out << " (" << bs.steps << "/" << bs.power << " steps)";
+        }
+        out << "\n";
+      }
+    }
+    out << "BOTTOM OF MemoryTrace STACK\n";
   } else {
     std::vector<StackFrameEntry> tmpFrames = stackFrames;
     out << "TOP OF MemoryTrace STACK\n";
-    for (auto it = trace.rbegin(); it != trace.rend(); ++it) {
-      const MemoryTraceEntry &entry = *it;
-      const InstructionInfo &ii = *entry.inst->info;
-      if (!tmpFrames.empty()) {
-        if (static_cast<std::size_t>(trace.rend() - it) ==
-            tmpFrames.back().index) {
-          out << "STACKFRAME BOUNDARY " << tmpFrames.size() << "/"
-              << stackFrames.size() << "\n";
-          tmpFrames.pop_back();
+    // walk through the chunks from the topmost visible entry downwards
+    std::size_t end = traceSize;
+    for (const TraceChunk *chunk = head.get(); chunk != nullptr;
+         chunk = chunk->previous.get()) {
+      for (std::size_t i = end; i-- > chunk->offset;) {
+        const KInstruction *inst = chunk->getInstruction(i - chunk->offset);
+        const fingerprint_t &fingerprint =
+            chunk->getFingerprint(i - chunk->offset);
+        const InstructionInfo &ii = *inst->info;
+        if (!tmpFrames.empty()) {
+          if (i + 1 == tmpFrames.back().index) {
+            out << "STACKFRAME BOUNDARY " << tmpFrames.size() << "/"
+                << stackFrames.size() << "\n";
+            tmpFrames.pop_back();
+          }
         }
+        out << inst << " (" << ii.file << ":" << ii.line << ":" << ii.id
+            << "): " << MemoryFingerprint::toString(fingerprint) << "\n";
       }
-      out << entry.inst << " (" << ii.file << ":" << ii.line << ":" << ii.id
-          << "): " << MemoryFingerprint::toString(entry.fingerprint) << "\n";
+      end = chunk->offset;
     }
     out << "BOTTOM OF MemoryTrace STACK\n";
   }
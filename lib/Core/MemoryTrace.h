@@ -3,8 +3,13 @@
 
 #include "MemoryFingerprint.h"
 
+#include "klee/ADT/ImmutableMap.h"
+#include "klee/ADT/Ref.h"
 #include "klee/Module/KInstruction.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
 
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace llvm {
@@ -12,7 +17,6 @@ class Function;
 }
 
 namespace klee {
-class ExecutionState;
 class MemoryObject;
 struct StackFrame;
 
@@ -38,6 +42,109 @@ private:
     }
   };
 
+  // Key of an entry in the compact layout, i.e. the instruction id in the
+  // upper and the fingerprint id in the lower 32 bits. As instructions and
+  // fingerprints are interned, two entries are equal iff their keys are.
+  using compact_entry_t = std::uint64_t;
+
+  // Entries are stored in a list of chunks that is shared between the
+  // MemoryTraces of forked states. Every chunk links to the chunk holding the
+  // preceding entries and is only appended to while it is referenced by a
+  // single MemoryTrace. Hence, visible entries are never modified and their
+  // addresses remain stable.
+  struct TraceChunk {
+    class ReferenceCounter _refCount;
+    // chunk that contains the preceding entries
+    ref<TraceChunk> previous;
+    // number of entries preceding this chunk
+    std::size_t offset;
+    // Only one of the following layouts is used, depending on
+    // -infinite-loop-detection-compact-trace. Neither grows beyond its initial
+    // capacity, i.e. they are never reallocated.
+    std::vector<MemoryTraceEntry> entries;
+    // compact layout: ids of interned instructions and fingerprints
+    std::vector<std::uint32_t> instructionIds;
+    std::vector<std::uint32_t> fingerprintIds;
+
+    TraceChunk(ref<TraceChunk> previous, std::size_t offset,
+               std::size_t capacity);
+    ~TraceChunk();
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    // remove all entries at or above position (relative to offset)
+    void erase(std::size_t position);
+    const KInstruction *getInstruction(std::size_t position) const;
+    const fingerprint_t &getFingerprint(std::size_t position) const;
+    compact_entry_t getCompactEntry(std::size_t position) const;
+  };
+
+  // capacity of the first chunk after a fork and upper bound for the
+  // capacity of subsequent chunks
+  static constexpr std::size_t minChunkCapacity = 8;
+  static constexpr std::size_t maxChunkCapacity = 256;
+
+  struct MemoryTraceEntryLT {
+    bool operator()(const MemoryTraceEntry *lhs,
+                    const MemoryTraceEntry *rhs) const {
+      if (lhs->inst != rhs->inst)
+        return std::less<const KInstruction *>()(lhs->inst, rhs->inst);
+      return lhs->fingerprint < rhs->fingerprint;
+    }
+  };
+
+  // persistent map from the first occurrence of every distinct entry to its
+  // position
+  using index_t =
+      ImmutableMap<const MemoryTraceEntry *, std::size_t, MemoryTraceEntryLT>;
+  // compact layout: maps every distinct key to the position of its first
+  // occurrence
+  using compact_index_t = ImmutableMap<compact_entry_t, std::size_t>;
+
+  struct StackFrameIndex {
+    index_t index;
+    compact_index_t compactIndex;
+    // first entry of the stack frame (nullptr if it has no entries yet)
+    const MemoryTraceEntry *base = nullptr;
+    compact_entry_t compactBase = 0;
+    // number of entries registered in this stack frame (including evicted
+    // ones)
+    std::size_t registered = 0;
+    // number of entries whose instruction has already been registered in
+    // this stack frame with a different fingerprint
+    std::size_t revisits = 0;
+    // offset (relative to the stack frame, in registered entries) of the
+    // oldest entry that has been retained by the last eviction together with
+    // all newer ones (0 if nothing has been evicted yet)
+    std::size_t windowStart = 0;
+  };
+
+  // -infinite-loop-detection-algorithm=brent: instead of entries, only the
+  // following is stored for every stack frame
+  struct BrentState {
+    // first entry of the stack frame
+    MemoryTraceEntry base = MemoryTraceEntry(nullptr, fingerprint_t());
+    // entry that all subsequent entries are compared to
+    MemoryTraceEntry checkpoint = MemoryTraceEntry(nullptr, fingerprint_t());
+    // entries registered since the checkpoint has been set
+    std::size_t steps = 0;
+    // number of steps after which the checkpoint is moved
+    std::size_t power = 1;
+    // steps between checkpoint and topmost entry if both are equal (0 if not)
+    std::size_t period = 0;
+  };
+
+  // -infinite-loop-detection-truncate-loops: state of a stack frame before a
+  // loop nest has been entered, restored when the loop nest is left
+  struct LoopScope {
+    // stack frame (index into indices) the loop belongs to
+    std::size_t frame;
+    // depth of the innermost loop that has been entered
+    unsigned depth;
+    std::size_t traceSize;
+    StackFrameIndex index;
+  };
+
 public:
   struct StackFrameEntry {
     // first index in stack that belongs to next stack frame
@@ -58,24 +165,70 @@ public:
   };
 
 private:
-  std::vector<MemoryTraceEntry> trace;
+  // chunk that contains the topmost entry
+  ref<TraceChunk> head;
+  // number of entries visible to this MemoryTrace
+  std::size_t traceSize = 0;
   std::vector<StackFrameEntry> stackFrames;
+  // one index per stack frame (the last one belongs to the current stack
+  // frame), both are shared with forked states
+  std::vector<StackFrameIndex> indices = std::vector<StackFrameIndex>(1);
+  // one per stack frame (only with -infinite-loop-detection-algorithm=brent)
+  std::vector<BrentState> brentStates = std::vector<BrentState>(
+      InfiniteLoopDetectionAlgorithm == DETECT_WITH_BRENT ? 1 : 0);
+  // innermost loop scope last (only with
+  // -infinite-loop-detection-truncate-loops)
+  std::vector<LoopScope> loopScopes;
+
+  const MemoryTraceEntry &appendEntry(const KInstruction *instruction,
+                                      const fingerprint_t &fingerprint);
+  void appendCompactEntry(compact_entry_t key);
+  bool isHeadAppendable();
+  void startChunk();
+  void truncate(std::size_t size);
+  void appendToCurrentStackFrame(const KInstruction *instruction,
+                                 const fingerprint_t &fingerprint);
+  // -infinite-loop-detection-max-frame-entries: number of newest entries and
+  // maximum number of checkpoints (offsets that are powers of two) retained
+  // by an eviction
+  static void getEvictionBudget(std::size_t &window,
+                                std::size_t &maxCheckpoints);
+  // smallest checkpoint retained by an eviction with the given window start
+  // (windowStart if there is none)
+  static std::size_t getMinCheckpoint(std::size_t windowStart,
+                                      std::size_t maxCheckpoints);
+  // offsets (relative to the stack frame, in registered entries) of the
+  // numEntries entries of a stack frame
+  static void getRetainedOffsets(const StackFrameIndex &frame,
+                                 std::size_t numEntries,
+                                 std::vector<std::size_t> &offsets);
+  // offset (relative to the stack frame, in registered entries) of the entry
+  // at the given position within the retained entries of a stack frame
+  static std::size_t getRegisteredOffset(const StackFrameIndex &frame,
+                                         std::size_t position);
+  void evictEntries();
+  void updateBrentState(const MemoryTraceEntry &entry);
+  bool hasEqualStackFrameBase(std::size_t i, std::size_t j) const;
 
 public:
   MemoryTrace() = default;
   MemoryTrace(const MemoryTrace &) = default;
 
   std::pair<std::size_t, std::size_t> getTraceLength() const {
-    return std::make_pair(trace.size(), stackFrames.size());
+    return std::make_pair(traceSize, stackFrames.size());
   }
 
   std::pair<std::size_t, std::size_t> getTraceCapacity() const {
-    return std::make_pair(trace.capacity(), stackFrames.capacity());
+    std::size_t capacity = 0;
+    if (!head.isNull())
+      capacity = head->offset + head->capacity();
+    return std::make_pair(capacity, stackFrames.capacity());
   }
 
-  static std::pair<std::size_t, std::size_t> getTraceStructSizes() {
-    return std::make_pair(sizeof(MemoryTraceEntry), sizeof(StackFrameEntry));
-  }
+  static std::pair<std::size_t, std::size_t> getTraceStructSizes();
+  // size of the node that every distinct entry adds to the index of its
+  // stack frame (in addition to the entry itself)
+  static std::size_t getTraceIndexNodeSize();
 
   std::size_t getNumberOfEntriesInCurrentStackFrame() const {
     auto stackFramesIt = stackFrames.rbegin();
@@ -86,7 +239,14 @@ public:
     }
 
     // calculate number of entries within first stack frame
-    return trace.size() - topStackFrameBoundary;
+    return traceSize - topStackFrameBoundary;
+  }
+
+  // number of entries in the current stack frame that revisit an
+  // instruction with a different fingerprint, i.e. partial repetitions (not
+  // counted with -infinite-loop-detection-algorithm=brent)
+  std::size_t getNumberOfRevisitsInCurrentStackFrame() const {
+    return indices.back().revisits;
   }
 
   void registerBasicBlock(const KInstruction *instruction,
@@ -95,14 +255,28 @@ public:
                                fingerprint_t fingerprintLocalDelta,
                                fingerprint_t fingerprintAllocaDelta);
   StackFrameEntry popFrame();
+  // loops up to the given depth (relative to the function) have been entered
+  // in the current stack frame
+  void enterLoop(unsigned depth);
+  // all loops deeper than the given depth have been left in the current stack
+  // frame: remove the entries registered since entering the outermost of them
+  void leaveLoops(unsigned depth);
   bool findInfiniteLoopInFunction() const;
   bool findInfiniteRecursion() const;
+  // number of registered basic blocks between the topmost entry and an
+  // equal entry in the current stack frame (0 if there is none)
+  std::size_t getInfiniteLoopPeriod() const;
+  // number of stack frames between the current stack frame and a previous
+  // one with equal stack frame base (0 if there is none)
+  std::size_t getInfiniteRecursionPeriod() const;
   void clear();
   std::size_t getNumberOfStackFrames() const;
 
-  static bool isAllocaAllocationInCurrentStackFrame(const ExecutionState &state,
+  // stackSize is the number of stack frames of the ExecutionState that are
+  // represented by this MemoryTrace (including the current one)
+  static bool isAllocaAllocationInCurrentStackFrame(std::size_t stackSize,
                                                     const MemoryObject &mo);
-  fingerprint_t *getPreviousAllocaDelta(const ExecutionState &state,
+  fingerprint_t *getPreviousAllocaDelta(std::size_t stackSize,
                                         const MemoryObject &mo);
 
   void dumpTrace(llvm::raw_ostream &out = llvm::errs()) const;
@@ -162,6 +162,7 @@ WeightedRandomSearcher::WeightedRandomSearcher(WeightType type, RNG &rng)
   case QueryCost:
   case MinDistToUncovered:
   case CoveringNew:
+  case Liveness:
     updateWeights = true;
     break;
   default:
@@ -211,6 +212,16 @@ double WeightedRandomSearcher::getWeight(ExecutionState *es) {
         return invMD2U * invMD2U;
       }
     }
+    case Liveness: {
+      // Favor infinite loop candidates: states that keep revisiting basic
+      // blocks of the current stack frame with different fingerprints. Input
+      // functions (and forks with -infinite-loop-detection-truncate-on-fork)
+      // clear the memory trace and thus reset the weight.
+      const MemoryState &ms = es->memoryState;
+      double entries = ms.getNumberOfEntriesInCurrentStackFrame();
+      double revisits = ms.getNumberOfRevisitsInCurrentStackFrame();
+      return (1. + revisits) * (1. + std::log2(1. + entries));
+    }
   }
 }
 
@@ -246,6 +257,7 @@ void WeightedRandomSearcher::printName(llvm::raw_ostream &os) {
     case CPInstCount        : os << "CPInstCount\n"; return;
     case MinDistToUncovered : os << "MinDistToUncovered\n"; return;
     case CoveringNew        : os << "CoveringNew\n"; return;
+    case Liveness           : os << "Liveness\n"; return;
     default                 : os << "<unknown type>\n"; return;
   }
 }
@@ -519,6 +531,60 @@ void IterativeDeepeningTimeSearcher::printName(llvm::raw_ostream &os) {
 }
 
 
+///
+
+DeprioritizingSearcher::DeprioritizingSearcher(Searcher *baseSearcher)
+  : baseSearcher{baseSearcher} {};
+
+ExecutionState &DeprioritizingSearcher::selectState() {
+  return baseSearcher->selectState();
+}
+
+void DeprioritizingSearcher::update(ExecutionState *current,
+                                    const std::vector<ExecutionState *> &addedStates,
+                                    const std::vector<ExecutionState *> &removedStates) {
+  // update underlying searcher (filter paused states unknown to underlying searcher)
+  if (!removedStates.empty()) {
+    std::vector<ExecutionState *> alt = removedStates;
+    for (const auto state : removedStates) {
+      auto it = pausedStates.find(state);
+      if (it != pausedStates.end()) {
+        pausedStates.erase(it);
+        alt.erase(std::remove(alt.begin(), alt.end(), state), alt.end());
+      }
+    }
+    baseSearcher->update(current, addedStates, alt);
+  } else {
+    baseSearcher->update(current, addedStates, removedStates);
+  }
+
+  // update current: pause if it is to be deprioritized
+  if (current && current->deprioritize &&
+      std::find(removedStates.begin(), removedStates.end(), current) == removedStates.end()) {
+    current->deprioritize = false;
+    pausedStates.insert(current);
+    baseSearcher->update(nullptr, {}, {current});
+  }
+
+  // no states left in underlying searcher: fill with paused states
+  if (baseSearcher->empty() && !pausedStates.empty()) {
+    std::vector<ExecutionState *> ps(pausedStates.begin(), pausedStates.end());
+    baseSearcher->update(nullptr, ps, std::vector<ExecutionState *>());
+    pausedStates.clear();
+  }
+}
+
+bool DeprioritizingSearcher::empty() {
+  return baseSearcher->empty() && pausedStates.empty();
+}
+
+void DeprioritizingSearcher::printName(llvm::raw_ostream &os) {
+  os << "<DeprioritizingSearcher> baseSearcher:\n";
+  baseSearcher->printName(os);
+  os << "</DeprioritizingSearcher>\n";
+}
+
+
 ///
 
 InterleavedSearcher::InterleavedSearcher(const std::vector<Searcher*> &_searchers) {
@@ -71,7 +71,8 @@ namespace klee {
       NURS_RP,
       NURS_ICnt,
       NURS_CPICnt,
-      NURS_QC
+      NURS_QC,
+      NURS_Liveness
     };
   };
 
@@ -131,7 +132,8 @@ namespace klee {
       InstCount,
       CPInstCount,
       MinDistToUncovered,
-      CoveringNew
+      CoveringNew,
+      Liveness
     };
 
   private:
@@ -139,7 +141,10 @@ namespace klee {
     RNG &theRNG;
     WeightType type;
     bool updateWeights;
-    
+
+#ifdef KLEE_UNITTEST
+  public:
+#endif
     double getWeight(ExecutionState*);
 
   public:
@@ -289,6 +294,28 @@ namespace klee {
     void printName(llvm::raw_ostream &os) override;
   };
 
+  /// DeprioritizingSearcher selects states from an underlying searcher. A
+  /// state that is marked to be deprioritized, e.g. as a duplicate of
+  /// another one (ExecutionState::deprioritize), is paused (removed from the
+  /// underlying searcher). When the underlying searcher runs out of states,
+  /// all paused states are revived (added to the underlying searcher).
+  class DeprioritizingSearcher final : public Searcher {
+    std::unique_ptr<Searcher> baseSearcher;
+    std::set<ExecutionState*> pausedStates;
+
+  public:
+    /// \param baseSearcher The underlying searcher (takes ownership).
+    explicit DeprioritizingSearcher(Searcher *baseSearcher);
+    ~DeprioritizingSearcher() override = default;
+
+    ExecutionState &selectState() override;
+    void update(ExecutionState *current,
+                const std::vector<ExecutionState *> &addedStates,
+                const std::vector<ExecutionState *> &removedStates) override;
+    bool empty() override;
+    void printName(llvm::raw_ostream &os) override;
+  };
+
   /// InterleavedSearcher selects states from a set of searchers in round-robin
   /// manner. It is used for KLEE's default strategy where it switches between
   /// RandomPathSearcher and WeightedRandomSearcher with CoveringNew metric.
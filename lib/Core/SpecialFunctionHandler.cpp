@@ -89,6 +89,7 @@ static SpecialFunctionHandler::HandlerInfo handlerInfo[] = {
   add("klee_clear_memory_state", handleClearMemoryState, false),
   add("klee_disable_memory_state", handleDisableMemoryState, false),
   add("klee_enable_memory_state", handleEnableMemoryState, false),
+  add("klee_exclude_from_memory_state", handleExcludeFromMemoryState, false),
   add("klee_dump_memory_trace", handleDumpMemoryTrace, false),
   add("klee_get_valuef", handleGetValue, true),
   add("klee_get_valued", handleGetValue, true),
@@ -830,6 +831,25 @@ void SpecialFunctionHandler::handleEnableMemoryState(ExecutionState &state,
   }
 }
 
+void SpecialFunctionHandler::handleExcludeFromMemoryState(
+    ExecutionState &state, KInstruction *target,
+    std::vector<ref<Expr>> &arguments) {
+  assert(arguments.size() == 1 &&
+         "invalid number of arguments to klee_exclude_from_memory_state");
+
+  if (!DetectInfiniteLoops)
+    return;
+
+  Executor::ExactResolutionList rl;
+  executor.resolveExact(state, arguments[0], rl, "exclude_from_memory_state");
+
+  for (auto &it : rl) {
+    const MemoryObject *mo = it.first.first;
+    const ObjectState *os = it.first.second;
+    it.second->memoryState.excludeFromFingerprint(*mo, *os);
+  }
+}
+
 void SpecialFunctionHandler::handleDumpMemoryTrace(ExecutionState &state,
                                                           KInstruction *target,
                                                           std::vector<ref<Expr>>
@@ -109,6 +109,7 @@ namespace klee {
     HANDLER(handleClearMemoryState);
     HANDLER(handleDisableMemoryState);
     HANDLER(handleEnableMemoryState);
+    HANDLER(handleExcludeFromMemoryState);
     HANDLER(handleDumpMemoryTrace);
     HANDLER(handleDefineFixedObject);
     HANDLER(handleDelete);    
@@ -0,0 +1,159 @@
+#include "StateFingerprintTable.h"
+
+#include "ExecutionState.h"
+#include "Memory.h"
+
+#include "klee/Expr/Expr.h"
+#include "klee/Expr/ExprUtil.h"
+#include "klee/Module/Cell.h"
+#include "klee/Module/KModule.h"
+
+#include "llvm/ADT/Hashing.h"
+
+#include <algorithm>
+
+namespace klee {
+
+std::size_t StateFingerprintTable::hashConstraints(
+    ConstraintSet::constraint_iterator begin,
+    ConstraintSet::constraint_iterator end) {
+  std::size_t result = std::distance(begin, end);
+  for (auto it = begin; it != end; ++it) {
+    result = llvm::hash_combine(result, (*it)->hash());
+  }
+  return result;
+}
+
+void StateFingerprintTable::findReferencedArrays(
+    const ExecutionState &state, std::set<const Array *> &arrays) {
+  std::vector<ref<Expr>> values;
+  for (const auto &object : state.addressSpace.objects) {
+    const ObjectState *os = object.second.get();
+    for (unsigned i = 0; i < os->size; ++i) {
+      if (os->readConcreteRange(i, i + 1) == nullptr)
+        values.push_back(os->read8(i));
+    }
+  }
+  auto addLocal = [&values](const ref<Expr> &value) {
+    if (!value.isNull() && !isa<ConstantExpr>(value))
+      values.push_back(value);
+  };
+  // as in the fingerprint: all locals of calling stack frames, but only the
+  // live locals of the current basic block (state.pc) in the current one
+  for (std::size_t i = 0; i + 1 < state.stack.size(); ++i) {
+    const StackFrame &sf = state.stack[i];
+    for (unsigned reg = 0; reg < sf.kf->numRegisters; ++reg)
+      addLocal(sf.locals[reg].value);
+  }
+  const StackFrame &sf = state.stack.back();
+  KFunction::liveset_t liveSet = sf.kf->getLiveLocals(state.pc->basicBlockId);
+  for (unsigned index : liveSet.args)
+    addLocal(sf.locals[sf.kf->getArgRegister(index)].value);
+  for (const KInstruction *ki : liveSet.inst)
+    addLocal(sf.locals[ki->dest].value);
+
+  // a single search shares the visited update lists of all values
+  std::vector<const Array *> results;
+  findSymbolicObjects(values.begin(), values.end(), results);
+  arrays.insert(results.begin(), results.end());
+}
+
+std::set<ref<Expr>> StateFingerprintTable::getRelevantConstraints(
+    ConstraintSet::constraint_iterator begin,
+    ConstraintSet::constraint_iterator end, std::set<const Array *> arrays) {
+  std::vector<std::pair<ref<Expr>, std::vector<const Array *>>> pending;
+  for (auto it = begin; it != end; ++it) {
+    pending.emplace_back(*it, std::vector<const Array *>());
+    findSymbolicObjects(*it, pending.back().second);
+  }
+
+  // constraints that share an array with the state, directly or through
+  // other relevant constraints
+  std::set<ref<Expr>> relevant;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = pending.begin(); it != pending.end();) {
+      const std::vector<const Array *> &used = it->second;
+      if (std::none_of(used.begin(), used.end(), [&arrays](const Array *a) {
+            return arrays.count(a) != 0;
+          })) {
+        ++it;
+        continue;
+      }
+      relevant.insert(it->first);
+      arrays.insert(used.begin(), used.end());
+      it = pending.erase(it);
+      changed = true;
+    }
+  }
+  return relevant;
+}
+
+bool StateFingerprintTable::insert(
+    const MemoryFingerprint::fingerprint_t &fingerprint,
+    const ExecutionState &state) {
+  std::vector<Entry> &candidates = entries[fingerprint];
+
+  // the same state reaching a configuration again is an infinite loop (or
+  // one that the memory trace has forgotten about)
+  for (const Entry &entry : candidates) {
+    if (entry.state == &state)
+      return false;
+  }
+
+  // Only constraints on arrays that the configuration refers to can
+  // influence the paths taken from there on. As both states have the same
+  // fingerprint, the arrays are determined from the current state.
+  std::set<const Array *> arrays;
+  std::set<ref<Expr>> relevant;
+  bool collected = false;
+  for (const Entry &entry : candidates) {
+    const ConstraintSet &constraints = entry.state->constraints;
+    if (constraints.size() < entry.numConstraints)
+      continue;
+    auto end = std::next(constraints.begin(), entry.numConstraints);
+    if (hashConstraints(constraints.begin(), end) != entry.constraintsHash) {
+      // constraints have been rewritten since
+      continue;
+    }
+
+    if (!collected) {
+      findReferencedArrays(state, arrays);
+      relevant = getRelevantConstraints(state.constraints.begin(),
+                                        state.constraints.end(), arrays);
+      collected = true;
+    }
+    if (getRelevantConstraints(constraints.begin(), end, arrays) == relevant)
+      return true;
+  }
+
+  candidates.push_back({&state, state.constraints.size(),
+                        hashConstraints(state.constraints.begin(),
+                                        state.constraints.end())});
+  stateEntries[&state].push_back(fingerprint);
+  ++numEntries;
+  return false;
+}
+
+void StateFingerprintTable::remove(const ExecutionState &state) {
+  auto it = stateEntries.find(&state);
+  if (it == stateEntries.end())
+    return;
+
+  for (const MemoryFingerprint::fingerprint_t &fingerprint : it->second) {
+    auto candidates = entries.find(fingerprint);
+    std::vector<Entry> &list = candidates->second;
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [&state](const Entry &entry) {
+                                return entry.state == &state;
+                              }),
+               list.end());
+    if (list.empty())
+      entries.erase(candidates);
+    --numEntries;
+  }
+  stateEntries.erase(it);
+}
+
+} // namespace klee
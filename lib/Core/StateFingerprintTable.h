@@ -0,0 +1,79 @@
+#ifndef KLEE_STATEFINGERPRINTTABLE_H
+#define KLEE_STATEFINGERPRINTTABLE_H
+
+#include "MemoryFingerprint.h"
+
+#include "klee/Expr/Constraints.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace klee {
+class Array;
+class ExecutionState;
+
+/// Fingerprints of the configurations (see
+/// MemoryState::getStateFingerprint()) in which states reached loop headers,
+/// together with the constraints of the first state that reached each of
+/// them. A state that reaches a configuration that another state has reached
+/// before is a duplicate of it if both have equal constraints on the
+/// symbolic arrays that the configuration refers to, i.e. they can take the
+/// same paths from there on (-infinite-loop-detection-duplicate-states).
+///
+/// Entries only refer to the constraints of a live state, so they are
+/// removed when that state terminates.
+class StateFingerprintTable {
+  struct Entry {
+    // first state that reached the configuration
+    const ExecutionState *state;
+    // the first numConstraints constraints of state were its constraints
+    // at that point, as long as their hash is still constraintsHash
+    std::size_t numConstraints;
+    std::size_t constraintsHash;
+  };
+
+  struct FingerprintHash {
+    std::size_t operator()(const MemoryFingerprint::fingerprint_t &fp) const {
+      return MemoryFingerprint::hash(fp);
+    }
+  };
+
+  std::unordered_map<MemoryFingerprint::fingerprint_t, std::vector<Entry>,
+                     FingerprintHash>
+      entries;
+  // fingerprints of the entries of each state
+  std::unordered_map<const ExecutionState *,
+                     std::vector<MemoryFingerprint::fingerprint_t>>
+      stateEntries;
+  std::size_t numEntries = 0;
+
+  static std::size_t
+  hashConstraints(ConstraintSet::constraint_iterator begin,
+                  ConstraintSet::constraint_iterator end);
+  // arrays referenced by the memory and the locals of state, which has to be
+  // at the beginning of a basic block
+  static void findReferencedArrays(const ExecutionState &state,
+                                   std::set<const Array *> &arrays);
+  static std::set<ref<Expr>>
+  getRelevantConstraints(ConstraintSet::constraint_iterator begin,
+                         ConstraintSet::constraint_iterator end,
+                         std::set<const Array *> arrays);
+
+public:
+  /// Insert the configuration of state with the given fingerprint. Returns
+  /// true if a different state has reached it before with equal constraints
+  /// on the symbolic arrays it refers to.
+  bool insert(const MemoryFingerprint::fingerprint_t &fingerprint,
+              const ExecutionState &state);
+
+  /// Remove all entries of state, has to be called before it is destroyed.
+  void remove(const ExecutionState &state);
+
+  std::size_t size() const { return numEntries; }
+};
+} // namespace klee
+
+#endif
@@ -14,6 +14,7 @@
 #include "Searcher.h"
 
 #include "klee/Support/ErrorHandling.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
 
 #include "llvm/Support/CommandLine.h"
 
@@ -47,7 +48,10 @@ cl::list<Searcher::CoreSearchType> CoreSearch(
                    "use NURS with Instr-Count"),
         clEnumValN(Searcher::NURS_CPICnt, "nurs:cpicnt",
                    "use NURS with CallPath-Instr-Count"),
-        clEnumValN(Searcher::NURS_QC, "nurs:qc", "use NURS with Query-Cost")
+        clEnumValN(Searcher::NURS_QC, "nurs:qc", "use NURS with Query-Cost"),
+        clEnumValN(Searcher::NURS_Liveness, "nurs:liveness",
+                   "use NURS with revisits of basic blocks in the memory trace "
+                   "(with -detect-infinite-loops)")
             KLEE_LLVM_CL_VAL_END),
     cl::cat(SearchCat));
 
@@ -118,6 +122,7 @@ Searcher *getNewSearcher(Searcher::CoreSearchType type, RNG &rng, PTree &process
     case Searcher::NURS_ICnt: searcher = new WeightedRandomSearcher(WeightedRandomSearcher::InstCount, rng); break;
     case Searcher::NURS_CPICnt: searcher = new WeightedRandomSearcher(WeightedRandomSearcher::CPInstCount, rng); break;
     case Searcher::NURS_QC: searcher = new WeightedRandomSearcher(WeightedRandomSearcher::QueryCost, rng); break;
+    case Searcher::NURS_Liveness: searcher = new WeightedRandomSearcher(WeightedRandomSearcher::Liveness, rng); break;
   }
 
   return searcher;
@@ -146,6 +151,12 @@ Searcher *klee::constructUserSearcher(Executor &executor) {
     searcher = new IterativeDeepeningTimeSearcher(searcher);
   }
 
+  if (InfiniteLoopDetectionDuplicateStates == DUPLICATES_DEPRIORITIZE ||
+      (InfiniteLoopDetectionMaxLoopIterations &&
+       InfiniteLoopDetectionSuspectedLoops == SUSPECTED_DEPRIORITIZE)) {
+    searcher = new DeprioritizingSearcher(searcher);
+  }
+
   if (UseMerge) {
     auto *ms = new MergingSearcher(searcher);
     executor.setMergingSearcher(ms);
@@ -0,0 +1,55 @@
+//===-- ContentHasher.h -----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_CONTENTHASHER_H
+#define KLEE_CONTENTHASHER_H
+
+#include "klee/Expr/Expr.h"
+#include "klee/Support/FastHash.h"
+
+#include <cstdint>
+
+namespace klee {
+
+/// Accumulates 64-bit words into a 128-bit Expr::ContentHash using two lanes
+/// of FastHash::mix() rounds.
+class ContentHasher {
+  std::uint64_t lo = FastHash::secret0;
+  std::uint64_t hi = FastHash::secret1;
+
+public:
+  void add(std::uint64_t value) {
+    std::uint64_t newLo =
+        FastHash::mix(value ^ FastHash::secret1, lo ^ FastHash::secret2);
+    std::uint64_t newHi =
+        FastHash::mix(value ^ FastHash::secret3, hi ^ FastHash::secret0);
+    lo = newLo ^ hi;
+    hi = newHi ^ lo;
+  }
+
+  void add(const Expr::ContentHash &hash) {
+    add(hash[0]);
+    add(hash[1]);
+  }
+
+  /// Returns the final hash, which is never all zero (as this value is used
+  /// to mark content hashes that have not been computed yet).
+  Expr::ContentHash get() const {
+    Expr::ContentHash result = {
+        FastHash::mix(lo ^ FastHash::secret3, hi ^ FastHash::secret0),
+        FastHash::mix(hi ^ FastHash::secret2, lo ^ FastHash::secret1)};
+    if (result[0] == 0 && result[1] == 0)
+      result[0] = 1;
+    return result;
+  }
+};
+
+} // namespace klee
+
+#endif /* KLEE_CONTENTHASHER_H */
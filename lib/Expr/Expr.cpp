@@ -9,6 +9,8 @@
 
 #include "klee/Expr/Expr.h"
 
+#include "ContentHasher.h"
+
 #include "klee/Config/Version.h"
 #include "klee/Expr/ExprPPrinter.h"
 #include "klee/Support/OptionCategories.h"
@@ -224,6 +226,67 @@ unsigned NotExpr::computeHash() {
   return hashValue;
 }
 
+void Expr::computeContentHash() const {
+  // Expressions can be nested arbitrarily deep (e.g. long chains of
+  // additions), thus we avoid recursion over kids and update lists and hash
+  // all missing expressions in post-order with an explicit stack instead.
+  std::vector<const Expr *> stack(1, this);
+  while (!stack.empty()) {
+    const Expr *e = stack.back();
+    if (e->hasContentHash()) {
+      stack.pop_back();
+      continue;
+    }
+
+    std::size_t missing = stack.size();
+    for (unsigned i = 0, n = e->getNumKids(); i != n; ++i) {
+      const Expr *kid = e->getKid(i).get();
+      if (!kid->hasContentHash())
+        stack.push_back(kid);
+    }
+    if (const ReadExpr *re = dyn_cast<ReadExpr>(e)) {
+      // updates that have not been hashed yet (see UpdateNode::contentHash())
+      for (const UpdateNode *un = re->updates.head.get();
+           un && !un->hasContentHash(); un = un->next.get()) {
+        if (!un->index->hasContentHash())
+          stack.push_back(un->index.get());
+        if (!un->value->hasContentHash())
+          stack.push_back(un->value.get());
+      }
+    }
+    if (stack.size() != missing)
+      continue;
+
+    // all kids and updates are hashed
+    ContentHasher hasher;
+    hasher.add(e->getKind());
+    hasher.add(e->getWidth());
+
+    switch (e->getKind()) {
+    case Constant: {
+      const APInt &value = cast<ConstantExpr>(e)->getAPValue();
+      for (unsigned i = 0; i != value.getNumWords(); ++i)
+        hasher.add(value.getRawData()[i]);
+      break;
+    }
+    case Extract:
+      hasher.add(cast<ExtractExpr>(e)->offset);
+      break;
+    case Read:
+      hasher.add(cast<ReadExpr>(e)->updates.contentHash());
+      break;
+    default:
+      break;
+    }
+
+    for (unsigned i = 0, n = e->getNumKids(); i != n; ++i)
+      hasher.add(e->getKid(i)->contentHashValue);
+
+    e->contentHashValue = hasher.get();
+    stack.pop_back();
+  }
+}
+
 ref<Expr> Expr::createFromKind(Kind k, std::vector<CreateArg> args) {
   unsigned numArgs = args.size();
   (void) numArgs;
@@ -528,6 +591,23 @@ unsigned Array::computeHash() {
   hashValue = res;
   return hashValue; 
 }
+
+const Expr::ContentHash &Array::contentHash() const {
+  if (hasContentHash())
+    return contentHashValue;
+
+  ContentHasher hasher;
+  hasher.add(name.size());
+  for (char c : name)
+    hasher.add(static_cast<unsigned char>(c));
+  hasher.add(size);
+  hasher.add(domain);
+  hasher.add(range);
+  for (const ref<ConstantExpr> &value : constantValues)
+    hasher.add(value->contentHash());
+  contentHashValue = hasher.get();
+  return contentHashValue;
+}
 /***/
 
 ref<Expr> ReadExpr::create(const UpdateList &ul, ref<Expr> index) {
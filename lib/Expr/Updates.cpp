@@ -9,7 +9,10 @@
 
 #include "klee/Expr/Expr.h"
 
+#include "ContentHasher.h"
+
 #include <cassert>
+#include <vector>
 
 using namespace klee;
 
@@ -43,6 +46,32 @@ unsigned UpdateNode::computeHash() {
   return hashValue;
 }
 
+const Expr::ContentHash &UpdateNode::contentHash() const {
+  if (hasContentHash())
+    return contentHashValue;
+
+  // Update lists can become very long, thus we avoid recursion over next and
+  // instead compute all missing hashes starting with the oldest update.
+  std::vector<const UpdateNode *> pending;
+  for (const UpdateNode *un = this; un; un = un->next.get()) {
+    if (un->hasContentHash())
+      break;
+    pending.push_back(un);
+  }
+
+  for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+    const UpdateNode *un = *it;
+    ContentHasher hasher;
+    hasher.add(un->index->contentHash());
+    hasher.add(un->value->contentHash());
+    if (un->next)
+      hasher.add(un->next->contentHashValue);
+    un->contentHashValue = hasher.get();
+  }
+
+  return contentHashValue;
+}
+
 ///
 
 UpdateList::UpdateList(const Array *_root, const ref<UpdateNode> &_head)
@@ -92,3 +121,12 @@ unsigned UpdateList::hash() const {
     res ^= head->hash();
   return res;
 }
+
+Expr::ContentHash UpdateList::contentHash() const {
+  ContentHasher hasher;
+  hasher.add(root->contentHash());
+  hasher.add(getSize());
+  if (head)
+    hasher.add(head->contentHash());
+  return hasher.get();
+}
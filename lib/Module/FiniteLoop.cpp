@@ -0,0 +1,156 @@
+//===-- FiniteLoop.cpp ----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Passes.h"
+
+#include "klee/Config/Version.h"
+
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+namespace klee {
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(12, 0)
+/// Replace the loop ID of L by a copy without "llvm.loop.mustprogress" and
+/// return the original loop ID, or nullptr if L is not marked as such.
+static MDNode *hideMustProgress(Loop *L) {
+  MDNode *loopID = L->getLoopID();
+  if (loopID == nullptr)
+    return nullptr;
+
+  SmallVector<Metadata *, 4> ops;
+  ops.push_back(nullptr); // reference to the new loop ID itself
+  bool found = false;
+  for (unsigned i = 1; i < loopID->getNumOperands(); ++i) {
+    const MDNode *option = dyn_cast<MDNode>(loopID->getOperand(i));
+    const MDString *name = nullptr;
+    if (option != nullptr && option->getNumOperands() > 0)
+      name = dyn_cast<MDString>(option->getOperand(0));
+    if (name != nullptr && name->getString() == "llvm.loop.mustprogress") {
+      found = true;
+      continue;
+    }
+    ops.push_back(loopID->getOperand(i));
+  }
+  if (!found)
+    return nullptr;
+
+  MDNode *hidden = MDNode::getDistinct(loopID->getContext(), ops);
+  hidden->replaceOperandWith(0, hidden);
+  L->setLoopID(hidden);
+  return loopID;
+}
+#endif
+
+bool FiniteLoopPass::runOnFunction(Function &F) {
+  this->F = &F;
+  basicBlocks.clear();
+  if (F.isDeclaration())
+    return false;
+
+  // entry points of all cycles, including irreducible ones
+  LoopHeaderPass lhp;
+  lhp.runOnFunction(F);
+
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  TargetLibraryInfoImpl TLII(Triple(F.getParent()->getTargetTriple()));
+  TargetLibraryInfo TLI(TLII);
+  AssumptionCache AC(F);
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(12, 0)
+  // With mustprogress (C++11 functions, C11 loops with a non-constant
+  // condition), ScalarEvolution assumes that the loop terminates and bounds
+  // e.g. `for (i = 0; i != n; i += 2)` although it runs forever for an odd n.
+  // Such a loop is exactly what we want to detect, so trip counts are
+  // computed without the attribute and metadata, which are restored below.
+  bool mustProgress = F.hasFnAttribute(Attribute::MustProgress);
+  if (mustProgress)
+    F.removeFnAttr(Attribute::MustProgress);
+  std::vector<std::pair<Loop *, MDNode *>> hiddenLoopIDs;
+  for (Loop *L : LI.getLoopsInPreorder()) {
+    if (MDNode *loopID = hideMustProgress(L))
+      hiddenLoopIDs.emplace_back(L, loopID);
+  }
+#endif
+
+  ScalarEvolution SE(F, TLI, AC, DT, LI);
+
+  for (BasicBlock &bb : F) {
+    const Loop *L = LI.getLoopFor(&bb);
+    if (L == nullptr)
+      continue;
+
+    // ScalarEvolution only bounds the number of iterations of L, i.e. how
+    // often its header is re-entered. An irreducible cycle within L that does
+    // not contain the header of L (or one of its sub-loops) could still
+    // execute forever.
+    bool irreducible = false;
+    for (const BasicBlock *block : L->blocks()) {
+      const Loop *inner = LI.getLoopFor(block);
+      if (lhp.isLoopHeader(block) && inner->getHeader() != block) {
+        irreducible = true;
+        break;
+      }
+    }
+    if (irreducible)
+      continue;
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(10, 0)
+    const SCEV *maxCount = SE.getConstantMaxBackedgeTakenCount(L);
+#else
+    const SCEV *maxCount = SE.getMaxBackedgeTakenCount(L);
+#endif
+    if (!isa<SCEVCouldNotCompute>(SE.getBackedgeTakenCount(L)) ||
+        !isa<SCEVCouldNotCompute>(maxCount)) {
+      basicBlocks.insert(&bb);
+    }
+  }
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(12, 0)
+  for (auto &hidden : hiddenLoopIDs)
+    hidden.first->setLoopID(hidden.second);
+  if (mustProgress)
+    F.addFnAttr(Attribute::MustProgress);
+#endif
+
+  return false;
+}
+
+void FiniteLoopPass::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesAll();
+}
+
+void FiniteLoopPass::print(raw_ostream &os, const Module *M) const {
+  os << "basic blocks in finite loops: {";
+  bool first = true;
+  if (F != nullptr) {
+    for (const BasicBlock &bb : *F) {
+      if (isInFiniteLoop(&bb)) {
+        os << (first ? "%" : ", %") << bb.getName();
+        first = false;
+      }
+    }
+  }
+  os << "}\n";
+}
+
+char FiniteLoopPass::ID = 0;
+static RegisterPass<FiniteLoopPass> X("finite-loop", "Finite Loop Pass", false,
+                                      true);
+
+} // namespace klee
@@ -23,6 +23,7 @@
 #include "klee/Support/InfiniteLoopDetectionFlags.h"
 #include "klee/Support/ModuleUtil.h"
 
+#include "llvm/Analysis/LoopInfo.h"
 #if LLVM_VERSION_CODE >= LLVM_VERSION(4, 0)
 #include "llvm/Bitcode/BitcodeWriter.h"
 #else
@@ -32,6 +33,7 @@
 #include "llvm/IR/CallSite.h"
 #endif
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -53,6 +55,7 @@
 #include "llvm/Transforms/Utils.h"
 #endif
 
+#include <algorithm>
 #include <sstream>
 
 using namespace llvm;
@@ -364,10 +367,62 @@ void KModule::manifest(InterpreterHandler *ih, bool forceSourceOutput) {
   }
 
   if (DetectInfiniteLoops) {
+    // loop headers are also where duplicate states are looked for and loop
+    // iterations are counted
+    bool findLoopHeaders =
+        InfiniteLoopDetectionLoopHeadersOnly ||
+        InfiniteLoopDetectionDuplicateStates != DUPLICATES_KEEP ||
+        InfiniteLoopDetectionMaxLoopIterations;
+    bool findLoops = InfiniteLoopDetectionTruncateLoops ||
+                     InfiniteLoopDetectionMaxLoopIterations;
     LiveRegisterPass lrp;
+    LoopHeaderPass lhp;
+    FiniteLoopPass flp;
+    WriteOnlyGlobalPass wogp;
+    if (InfiniteLoopDetectionIgnoreWriteOnlyGlobals) {
+      wogp.runOnModule(*module);
+      for (const GlobalVariable &gv : module->globals()) {
+        if (wogp.isWriteOnly(&gv))
+          excludedGlobals.insert(&gv);
+      }
+    }
     for (auto &kf : functions) {
       lrp.runOnFunction(*kf->function);
+      if (findLoopHeaders) {
+        lhp.runOnFunction(*kf->function);
+      }
+      if (InfiniteLoopDetectionSkipFiniteLoops) {
+        flp.runOnFunction(*kf->function);
+      }
+      if (findLoops && !kf->function->isDeclaration()) {
+        DominatorTree DT(*kf->function);
+        LoopInfo LI(DT);
+        std::map<const Loop *, unsigned> loopIds;
+        // preorder, i.e. every loop after its parent (as
+        // LoopInfo::getLoopsInPreorder(), which requires LLVM 5)
+        std::vector<const Loop *> loops(LI.rbegin(), LI.rend());
+        while (!loops.empty()) {
+          const Loop *L = loops.back();
+          loops.pop_back();
+          unsigned parent = 0;
+          if (L->getParentLoop() != nullptr)
+            parent = loopIds[L->getParentLoop()];
+          loopIds[L] = kf->loops.size();
+          kf->loops.push_back({parent, L->getLoopDepth()});
+          loops.insert(loops.end(), L->getSubLoops().rbegin(),
+                       L->getSubLoops().rend());
+        }
+        unsigned id = 0;
+        for (auto &bb : *kf->function) {
+          if (const Loop *L = LI.getLoopFor(&bb))
+            kf->basicBlocks[id].loop = loopIds[L];
+          ++id;
+        }
+      }
 
+      std::vector<const KInstruction *> liveInstSet;
+      std::vector<unsigned> liveArgsSet;
+      unsigned id = 0;
       for (auto &bb : *kf->function) {
         const auto *set =
             isa<PHINode>(bb.front())
@@ -375,10 +430,13 @@ void KModule::manifest(InterpreterHandler *ih, bool forceSourceOutput) {
                 : lrp.getBasicBlockLiveSet(&bb);
         assert(set != nullptr);
 
-        std::vector<const KInstruction *> liveInstSet;
-        std::vector<unsigned> liveArgsSet;
+        liveInstSet.clear();
+        liveArgsSet.clear();
         for (const Value *v : *set) {
           if (const auto *inst = dyn_cast<llvm::Instruction>(v)) {
+            // values of write-only globals are not part of the fingerprint
+            if (wogp.isWriteOnlyValue(inst))
+              continue;
             const InstructionInfo &ii = infos->getInfo(*inst);
             liveInstSet.push_back(ii.getKInstruction());
           } else if (const auto *arg = dyn_cast<llvm::Argument>(v)) {
@@ -386,7 +444,21 @@ void KModule::manifest(InterpreterHandler *ih, bool forceSourceOutput) {
           }
         }
 
-        kf->setLiveLocals(&bb, std::move(liveInstSet), std::move(liveArgsSet));
+        if (findLoopHeaders) {
+          kf->basicBlocks[id].isLoopHeader = lhp.isLoopHeader(&bb);
+        }
+        if (InfiniteLoopDetectionMaxLoopIterations) {
+          if (const auto *cycle = lhp.getIrreducibleCycle(&bb)) {
+            std::vector<unsigned> cycleIds;
+            for (const BasicBlock *member : *cycle)
+              cycleIds.push_back(kf->getBasicBlockId(*member));
+            kf->setIrreducibleCycle(id, std::move(cycleIds));
+          }
+        }
+        if (InfiniteLoopDetectionSkipFiniteLoops) {
+          kf->basicBlocks[id].isInFiniteLoop = flp.isInFiniteLoop(&bb);
+        }
+        kf->setLiveLocals(id++, liveInstSet, liveArgsSet);
       }
     }
   }
@@ -462,9 +534,13 @@ KFunction::KFunction(llvm::Function *_function,
     numArgs(function->arg_size()),
     numInstructions(0),
     trackCoverage(true) {
+  loops.push_back({0, 0});
+
   // Assign unique instruction IDs to each basic block
   for (auto &BasicBlock : *function) {
     basicBlockEntry[&BasicBlock] = numInstructions;
+    basicBlocks.push_back(
+        {numInstructions, 0, 0, 0, 0, false, false, 0, 0, 0});
     numInstructions += BasicBlock.size();
   }
 
@@ -483,8 +559,9 @@ KFunction::KFunction(llvm::Function *_function,
   numRegisters = rnum;
   
   unsigned i = 0;
+  unsigned bbId = 0;
   for (llvm::Function::iterator bbit = function->begin(), 
-         bbie = function->end(); bbit != bbie; ++bbit) {
+         bbie = function->end(); bbit != bbie; ++bbit, ++bbId) {
     for (llvm::BasicBlock::iterator it = bbit->begin(), ie = bbit->end();
          it != ie; ++it) {
       KInstruction *ki;
@@ -501,6 +578,7 @@ KFunction::KFunction(llvm::Function *_function,
       Instruction *inst = &*it;
       ki->inst = inst;
       ki->dest = registerMap[inst];
+      ki->basicBlockId = bbId;
 
       if (isa<CallInst>(it) || isa<InvokeInst>(it)) {
 #if LLVM_VERSION_CODE >= LLVM_VERSION(8, 0)
@@ -536,3 +614,33 @@ KFunction::~KFunction() {
     delete instructions[i];
   delete[] instructions;
 }
+
+unsigned KFunction::getBasicBlockId(const llvm::BasicBlock &bb) const {
+  auto it = basicBlockEntry.find(const_cast<llvm::BasicBlock *>(&bb));
+  assert(it != basicBlockEntry.end() && "basic block not in function");
+  return instructions[it->second]->basicBlockId;
+}
+
+void KFunction::setIrreducibleCycle(unsigned id, std::vector<unsigned> cycle) {
+  assert(id < basicBlocks.size());
+  KBasicBlock &kbb = basicBlocks[id];
+  std::sort(cycle.begin(), cycle.end());
+  kbb.cycleBegin = cycleBlocks.size();
+  cycleBlocks.insert(cycleBlocks.end(), cycle.begin(), cycle.end());
+  kbb.cycleEnd = cycleBlocks.size();
+}
+
+void KFunction::setLiveLocals(unsigned id,
+                              const std::vector<const KInstruction *> &inst,
+                              const std::vector<unsigned> &args) {
+  assert(id < basicBlocks.size());
+  assert((id == 0 || basicBlocks[id - 1].liveArgEnd == liveArguments.size()) &&
+         "live sets have to be set in ascending order of ids");
+  KBasicBlock &kbb = basicBlocks[id];
+  kbb.liveInstBegin = liveInstructions.size();
+  liveInstructions.insert(liveInstructions.end(), inst.begin(), inst.end());
+  kbb.liveInstEnd = liveInstructions.size();
+  kbb.liveArgBegin = liveArguments.size();
+  liveArguments.insert(liveArguments.end(), args.begin(), args.end());
+  kbb.liveArgEnd = liveArguments.size();
+}
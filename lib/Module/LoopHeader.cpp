@@ -0,0 +1,132 @@
+//===-- LoopHeader.cpp ----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Passes.h"
+
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+namespace klee {
+
+bool LoopHeaderPass::runOnFunction(Function &F) {
+  this->F = &F;
+  headers.clear();
+  irreducibleCycles.clear();
+  if (F.isDeclaration())
+    return false;
+
+  // headers of natural loops
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  std::vector<const Loop *> loops(LI.begin(), LI.end());
+  while (!loops.empty()) {
+    const Loop *L = loops.back();
+    loops.pop_back();
+    headers.insert(L->getHeader());
+    loops.insert(loops.end(), L->getSubLoops().begin(),
+                 L->getSubLoops().end());
+  }
+
+  // Irreducible cycles have no header that dominates all their blocks, but
+  // every cycle contains an edge that leads back to a basic block that is
+  // still on the stack of a depth-first traversal.
+  enum class Visit { NotVisited, OnStack, Finished };
+  std::unordered_map<const BasicBlock *, Visit> visited;
+  std::vector<std::pair<const BasicBlock *, unsigned>> stack;
+  stack.emplace_back(&F.getEntryBlock(), 0);
+  visited[&F.getEntryBlock()] = Visit::OnStack;
+  while (!stack.empty()) {
+    const BasicBlock *bb = stack.back().first;
+    unsigned successor = stack.back().second++;
+    // (a TerminatorInst before LLVM 8, which provides the successors there)
+    const auto *terminator = bb->getTerminator();
+    if (successor >= terminator->getNumSuccessors()) {
+      visited[bb] = Visit::Finished;
+      stack.pop_back();
+      continue;
+    }
+
+    const BasicBlock *next = terminator->getSuccessor(successor);
+    Visit &state = visited[next];
+    if (state == Visit::OnStack) {
+      if (headers.insert(next).second)
+        irreducibleCycles[next];
+    } else if (state == Visit::NotVisited) {
+      state = Visit::OnStack;
+      stack.emplace_back(next, 0);
+    }
+  }
+
+  // An irreducible cycle does not pass through the header of its innermost
+  // natural loop (otherwise, it would be part of that loop), so its basic
+  // blocks are those that can both be reached from and reach its entry point
+  // within that loop without the header.
+  for (auto &cycle : irreducibleCycles) {
+    const BasicBlock *entry = cycle.first;
+    const Loop *L = LI.getLoopFor(entry);
+    auto inRegion = [L](const BasicBlock *bb) {
+      return L == nullptr || (L->contains(bb) && L->getHeader() != bb);
+    };
+
+    std::unordered_set<const BasicBlock *> forward{entry};
+    std::vector<const BasicBlock *> worklist{entry};
+    while (!worklist.empty()) {
+      const BasicBlock *bb = worklist.back();
+      worklist.pop_back();
+      for (auto it = succ_begin(bb), ie = succ_end(bb); it != ie; ++it) {
+        if (inRegion(*it) && forward.insert(*it).second)
+          worklist.push_back(*it);
+      }
+    }
+
+    std::unordered_set<const BasicBlock *> backward{entry};
+    worklist.push_back(entry);
+    cycle.second.push_back(entry);
+    while (!worklist.empty()) {
+      const BasicBlock *bb = worklist.back();
+      worklist.pop_back();
+      for (auto it = pred_begin(bb), ie = pred_end(bb); it != ie; ++it) {
+        if (forward.count(*it) && backward.insert(*it).second) {
+          worklist.push_back(*it);
+          cycle.second.push_back(*it);
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+void LoopHeaderPass::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesAll();
+}
+
+void LoopHeaderPass::print(raw_ostream &os, const Module *M) const {
+  os << "loop headers: {";
+  bool first = true;
+  if (F != nullptr) {
+    for (const BasicBlock &bb : *F) {
+      if (isLoopHeader(&bb)) {
+        os << (first ? "%" : ", %") << bb.getName();
+        first = false;
+      }
+    }
+  }
+  os << "}\n";
+}
+
+char LoopHeaderPass::ID = 0;
+static RegisterPass<LoopHeaderPass> X("loop-header", "Loop Header Pass", false,
+                                      true);
+
+} // namespace klee
@@ -263,6 +263,90 @@ private:
   static void insertNopInstruction(llvm::BasicBlock &bb);
 };
 
+/// LoopHeaderPass - Determines the basic blocks through which every cycle in
+/// the control flow graph of a function is entered: headers of natural loops
+/// (as identified by LoopInfo) and entry points of irreducible cycles (targets
+/// of retreating edges in a depth-first traversal from the entry block).
+class LoopHeaderPass : public llvm::FunctionPass {
+  const llvm::Function *F = nullptr; // for print
+  std::unordered_set<const llvm::BasicBlock *> headers;
+  // basic blocks of the irreducible cycle entered through each entry point
+  std::unordered_map<const llvm::BasicBlock *,
+                     std::vector<const llvm::BasicBlock *>>
+      irreducibleCycles;
+
+public:
+  static char ID;
+  LoopHeaderPass() : FunctionPass(ID) {}
+
+  bool runOnFunction(llvm::Function &F) override;
+  void getAnalysisUsage(llvm::AnalysisUsage &Info) const override;
+  void print(llvm::raw_ostream &os, const llvm::Module *M) const override;
+
+  bool isLoopHeader(const llvm::BasicBlock *bb) const {
+    return headers.count(bb) != 0;
+  }
+  std::size_t getNumberOfLoopHeaders() const { return headers.size(); }
+
+  /// Basic blocks of the irreducible cycle entered through bb, i.e. of the
+  /// strongly connected component that contains bb within its innermost
+  /// natural loop (without the loop header), or nullptr if bb is not the
+  /// entry point of an irreducible cycle.
+  const std::vector<const llvm::BasicBlock *> *
+  getIrreducibleCycle(const llvm::BasicBlock *bb) const {
+    auto it = irreducibleCycles.find(bb);
+    return it == irreducibleCycles.end() ? nullptr : &it->second;
+  }
+};
+
+/// FiniteLoopPass - Determines which basic blocks belong to a loop that is
+/// known to terminate, i.e. whose innermost loop has a trip count that can be
+/// bounded by ScalarEvolution (e.g. counted loops with loop-invariant bounds).
+class FiniteLoopPass : public llvm::FunctionPass {
+  const llvm::Function *F = nullptr; // for print
+  std::unordered_set<const llvm::BasicBlock *> basicBlocks;
+
+public:
+  static char ID;
+  FiniteLoopPass() : FunctionPass(ID) {}
+
+  bool runOnFunction(llvm::Function &F) override;
+  void getAnalysisUsage(llvm::AnalysisUsage &Info) const override;
+  void print(llvm::raw_ostream &os, const llvm::Module *M) const override;
+
+  bool isInFiniteLoop(const llvm::BasicBlock *bb) const {
+    return basicBlocks.count(bb) != 0;
+  }
+};
+
+/// WriteOnlyGlobalPass - Determines global variables whose value never
+/// influences the execution: they are only accessed by non-volatile loads and
+/// stores, and every loaded value only flows (through arithmetic, casts, PHI
+/// nodes and selects) into stores to the same global, e.g. statistics
+/// counters. Also collects the instructions that hold such values.
+class WriteOnlyGlobalPass : public llvm::ModulePass {
+  const llvm::Module *M = nullptr; // for print
+  std::unordered_set<const llvm::GlobalVariable *> globals;
+  std::unordered_set<const llvm::Instruction *> values;
+
+public:
+  static char ID;
+  WriteOnlyGlobalPass() : ModulePass(ID) {}
+
+  bool runOnModule(llvm::Module &M) override;
+  void getAnalysisUsage(llvm::AnalysisUsage &Info) const override;
+  void print(llvm::raw_ostream &os, const llvm::Module *M) const override;
+
+  bool isWriteOnly(const llvm::GlobalVariable *gv) const {
+    return globals.count(gv) != 0;
+  }
+  /// Whether inst holds a value that only flows into write-only globals.
+  bool isWriteOnlyValue(const llvm::Instruction *inst) const {
+    return values.count(inst) != 0;
+  }
+  std::size_t getNumberOfWriteOnlyGlobals() const { return globals.size(); }
+};
+
 } // namespace klee
 
 #endif /* KLEE_PASSES_H */
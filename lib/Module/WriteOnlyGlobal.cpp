@@ -0,0 +1,124 @@
+//===-- WriteOnlyGlobal.cpp -----------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Passes.h"
+
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+namespace klee {
+
+/// Whether op may trap depending on its operand value, i.e. value is a
+/// divisor (division by zero) or shift amount (overshift), which the Executor
+/// checks for (-check-div-zero, -check-overshift).
+static bool mayTrapOn(const BinaryOperator *op, const Value *value) {
+  switch (op->getOpcode()) {
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::URem:
+  case Instruction::SRem:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+    return op->getOperand(1) == value;
+  default:
+    return false;
+  }
+}
+
+bool WriteOnlyGlobalPass::runOnModule(Module &M) {
+  this->M = &M;
+  globals.clear();
+  values.clear();
+
+  std::unordered_set<const Instruction *> closure;
+  std::vector<const Instruction *> worklist;
+  for (const GlobalVariable &gv : M.globals()) {
+    if (gv.isDeclaration() || gv.isConstant())
+      continue;
+
+    closure.clear();
+    worklist.clear();
+    bool writeOnly = true;
+    for (const User *user : gv.users()) {
+      if (const auto *store = dyn_cast<StoreInst>(user)) {
+        // the address of gv must not escape
+        writeOnly = !store->isVolatile() && store->getValueOperand() != &gv;
+      } else if (const auto *load = dyn_cast<LoadInst>(user)) {
+        writeOnly = !load->isVolatile();
+        if (closure.insert(load).second)
+          worklist.push_back(load);
+      } else {
+        // e.g. GEPs, calls or constant expressions
+        writeOnly = false;
+      }
+      if (!writeOnly)
+        break;
+    }
+
+    // every loaded value may only flow into stores to gv
+    while (writeOnly && !worklist.empty()) {
+      const Instruction *value = worklist.back();
+      worklist.pop_back();
+      for (const User *user : value->users()) {
+        if (const auto *store = dyn_cast<StoreInst>(user)) {
+          writeOnly = store->getPointerOperand() == &gv &&
+                      store->getValueOperand() == value;
+        } else if ((isa<BinaryOperator>(user) &&
+                    !mayTrapOn(cast<BinaryOperator>(user), value)) ||
+                   isa<CastInst>(user) || isa<PHINode>(user) ||
+                   (isa<SelectInst>(user) &&
+                    cast<SelectInst>(user)->getCondition() != value)) {
+          const auto *inst = cast<Instruction>(user);
+          if (closure.insert(inst).second)
+            worklist.push_back(inst);
+        } else {
+          writeOnly = false;
+        }
+        if (!writeOnly)
+          break;
+      }
+    }
+
+    if (writeOnly) {
+      globals.insert(&gv);
+      values.insert(closure.begin(), closure.end());
+    }
+  }
+
+  return false;
+}
+
+void WriteOnlyGlobalPass::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesAll();
+}
+
+void WriteOnlyGlobalPass::print(raw_ostream &os, const Module *M) const {
+  os << "write-only globals: {";
+  bool first = true;
+  if (this->M != nullptr) {
+    for (const GlobalVariable &gv : this->M->globals()) {
+      if (isWriteOnly(&gv)) {
+        os << (first ? "@" : ", @") << gv.getName();
+        first = false;
+      }
+    }
+  }
+  os << "}\n";
+}
+
+char WriteOnlyGlobalPass::ID = 0;
+static RegisterPass<WriteOnlyGlobalPass>
+    X("write-only-global", "Write-Only Global Pass", false, true);
+
+} // namespace klee
@@ -35,6 +35,46 @@
 // RUN: test -f %t-O3.klee-out/test000004.infty.err
 // RUN: test -f %t-O3.klee-out/test000005.infty.err
 
+// RUN: rm -rf %t-O3-compact.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O3-compact.klee-out -detect-infinite-loops -infinite-loop-detection-compact-trace -infinite-loop-detection-truncate-on-fork=false -emit-all-errors -max-instructions=100000 -allocate-determ %t-O3.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O3-compact.klee-out/test000001.infty.err
+// RUN: test -f %t-O3-compact.klee-out/test000002.infty.err
+// RUN: test -f %t-O3-compact.klee-out/test000003.infty.err
+// RUN: test -f %t-O3-compact.klee-out/test000004.infty.err
+// RUN: test -f %t-O3-compact.klee-out/test000005.infty.err
+
+// RUN: rm -rf %t-O0-headers.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-headers.klee-out -detect-infinite-loops -infinite-loop-detection-loop-headers-only -emit-all-errors -max-instructions=100000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-headers.klee-out/test000001.infty.err
+// RUN: test -f %t-O0-headers.klee-out/test000002.infty.err
+// RUN: test -f %t-O0-headers.klee-out/test000003.infty.err
+// RUN: test -f %t-O0-headers.klee-out/test000004.infty.err
+// RUN: test -f %t-O0-headers.klee-out/test000005.infty.err
+
+// RUN: rm -rf %t-O3-headers.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O3-headers.klee-out -detect-infinite-loops -infinite-loop-detection-loop-headers-only -emit-all-errors -max-instructions=100000 -allocate-determ %t-O3.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O3-headers.klee-out/test000001.infty.err
+// RUN: test -f %t-O3-headers.klee-out/test000002.infty.err
+// RUN: test -f %t-O3-headers.klee-out/test000003.infty.err
+// RUN: test -f %t-O3-headers.klee-out/test000004.infty.err
+// RUN: test -f %t-O3-headers.klee-out/test000005.infty.err
+
+// RUN: rm -rf %t-O0-truncate.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-truncate.klee-out -detect-infinite-loops -infinite-loop-detection-truncate-loops -emit-all-errors -max-instructions=100000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-truncate.klee-out/test000001.infty.err
+// RUN: test -f %t-O0-truncate.klee-out/test000002.infty.err
+// RUN: test -f %t-O0-truncate.klee-out/test000003.infty.err
+// RUN: test -f %t-O0-truncate.klee-out/test000004.infty.err
+// RUN: test -f %t-O0-truncate.klee-out/test000005.infty.err
+
+// RUN: rm -rf %t-O3-truncate.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O3-truncate.klee-out -detect-infinite-loops -infinite-loop-detection-truncate-loops -emit-all-errors -max-instructions=100000 -allocate-determ %t-O3.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O3-truncate.klee-out/test000001.infty.err
+// RUN: test -f %t-O3-truncate.klee-out/test000002.infty.err
+// RUN: test -f %t-O3-truncate.klee-out/test000003.infty.err
+// RUN: test -f %t-O3-truncate.klee-out/test000004.infty.err
+// RUN: test -f %t-O3-truncate.klee-out/test000005.infty.err
+
 #include <klee/klee.h>
 
 // x = 1: simple while true (continue)                  prints "aa..."
@@ -0,0 +1,65 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+// RUN: %clang %s -emit-llvm -O0 -g -c -DOVERWRITE -o %t-overwrite.bc
+
+// --- both states reach the loop in the same memory state, but with
+// --- different constraints on x, which is still in memory, so neither of
+// --- them is a duplicate
+// RUN: rm -rf %t-terminate.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-terminate.klee-out -detect-infinite-loops -infinite-loop-detection-duplicate-states=terminate -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: FileCheck -check-prefix=CHECK-NODUP %s < %t-terminate.klee-out/info
+
+// RUN: rm -rf %t-deprioritize.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-deprioritize.klee-out -detect-infinite-loops -infinite-loop-detection-duplicate-states=deprioritize -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: FileCheck -check-prefix=CHECK-NODUP %s < %t-deprioritize.klee-out/info
+
+// --- x is overwritten before the loop, so its constraints cannot influence
+// --- the paths from there on. With BFS, the first state forks after the loop
+// --- and is still alive when the second one reaches the loop.
+// RUN: rm -rf %t-overwrite-terminate.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-overwrite-terminate.klee-out -detect-infinite-loops -infinite-loop-detection-duplicate-states=terminate -search=bfs -allocate-determ %t-overwrite.bc 2>&1 | FileCheck -check-prefix=CHECK-TERMINATE %s
+// RUN: FileCheck -check-prefix=CHECK-DUP-TERMINATE %s < %t-overwrite-terminate.klee-out/info
+
+// RUN: rm -rf %t-overwrite-deprioritize.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-overwrite-deprioritize.klee-out -detect-infinite-loops -infinite-loop-detection-duplicate-states=deprioritize -search=bfs -allocate-determ %t-overwrite.bc 2>&1 | FileCheck -check-prefix=CHECK-DEPRIORITIZE %s
+// RUN: FileCheck -check-prefix=CHECK-DUP-DEPRIORITIZE %s < %t-overwrite-deprioritize.klee-out/info
+
+#include <klee/klee.h>
+
+int main(int argc, char *argv[]) {
+  int x;
+  klee_make_symbolic(&x, sizeof(x), "x");
+  int z;
+  klee_make_symbolic(&z, sizeof(z), "z");
+
+  int y;
+  if (x > 0) {
+    y = 1;
+  } else {
+    y = 1;
+  }
+#ifdef OVERWRITE
+  x = 0;
+#endif
+
+  int sum = 0;
+  for (int i = 0; i < 4; ++i) {
+    sum += y;
+  }
+
+#ifdef OVERWRITE
+  if (z > 0) {
+    sum += 1;
+  }
+#endif
+
+  // CHECK: KLEE: done: completed paths = 2
+  // CHECK: KLEE: done: generated tests = 2
+  // CHECK-NODUP-NOT: duplicate states
+  // CHECK-TERMINATE: KLEE: done: completed paths = 3
+  // CHECK-TERMINATE: KLEE: done: generated tests = 2
+  // CHECK-DEPRIORITIZE: KLEE: done: completed paths = 4
+  // CHECK-DEPRIORITIZE: KLEE: done: generated tests = 4
+  // CHECK-DUP-TERMINATE: KLEE: done: duplicate states = 1{{$}}
+  // CHECK-DUP-DEPRIORITIZE: KLEE: done: duplicate states = {{[1-9][0-9]*}}
+  return sum > 4 ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+
+// --- frexp() is an external function that only writes to its arguments
+// RUN: rm -rf %t.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t.klee-out/test000001.infty.err
+
+// --- unknown effects: the memory trace is cleared on every call
+// RUN: echo '{builtins: false}' > %t-unknown.yaml
+// RUN: rm -rf %t-unknown.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-unknown.klee-out -detect-infinite-loops -infinite-loop-detection-function-lists=%t-unknown.yaml -max-instructions=100000 -allocate-determ %t.bc 2>&1 | not FileCheck %s
+// RUN: not test -f %t-unknown.klee-out/test000001.infty.err
+
+// --- wrongly declared as pure: the write to exponent clears the memory trace
+// RUN: echo '{builtins: false, pure: [frexp]}' > %t-pure.yaml
+// RUN: rm -rf %t-pure.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-pure.klee-out -detect-infinite-loops -infinite-loop-detection-function-lists=%t-pure.yaml -max-instructions=100000 -allocate-determ %t.bc 2>&1 | not FileCheck %s
+// RUN: not test -f %t-pure.klee-out/test000001.infty.err
+
+// --- the objects frexp() may write to are not expected to be written by a
+// --- following call that is wrongly declared as pure
+// RUN: %clang %s -emit-llvm -O0 -g -c -DPURE_AFTER_ARGMEM -o %t-sequence.bc
+// RUN: echo '{builtins: false, argmem: [frexp], pure: [remquo]}' > %t-sequence.yaml
+// RUN: rm -rf %t-sequence.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-sequence.klee-out -detect-infinite-loops -infinite-loop-detection-function-lists=%t-sequence.yaml -max-instructions=100000 -allocate-determ %t-sequence.bc 2>&1 | not FileCheck %s
+// RUN: not test -f %t-sequence.klee-out/test000001.infty.err
+
+#include <math.h>
+
+int main(int argc, char *argv[]) {
+  double mantissa = 0;
+  int exponent = 0;
+
+  // CHECK: KLEE: ERROR: {{[^:]*}}/external-effects.c:{{[0-9]+}}: infinite loop{{$}}
+  while (1) {
+    exponent = 0;
+    mantissa = frexp(8.0, &exponent);
+#ifdef PURE_AFTER_ARGMEM
+    mantissa += remquo(5.0, 3.0, &exponent);
+#endif
+  }
+  return (int)mantissa;
+}
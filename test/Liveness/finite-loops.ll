@@ -0,0 +1,69 @@
+; RUN: llvm-as %s -f -o %t.bc
+
+; --- the counted loop is registered like any other loop
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -output-dir=%t.klee-out -detect-infinite-loops -debug-infinite-loop-detection=state:stderr -max-instructions=100000 -allocate-determ -optimize=false %t.bc > %t.log 2>&1
+; RUN: FileCheck -check-prefix=CHECK-REGISTER %s < %t.log
+; RUN: test -f %t.klee-out/test000001.infty.err
+
+; --- the counted loop is skipped, the wrapping loop is not
+; RUN: rm -rf %t-finite.klee-out
+; RUN: %klee -output-dir=%t-finite.klee-out -detect-infinite-loops -infinite-loop-detection-skip-finite-loops -debug-infinite-loop-detection=state:stderr -max-instructions=100000 -allocate-determ -optimize=false %t.bc > %t-finite.log 2>&1
+; RUN: FileCheck -check-prefix=CHECK-SKIP %s < %t-finite.log
+; RUN: test -f %t-finite.klee-out/test000001.infty.err
+
+; void wrapping(uint8_t n) {
+;   uint8_t i = 0;
+;   do i += 2; while (i != n);
+; }
+;
+; int main(int argc, char *argv[]) {
+;   int i = 0;
+;   do i++; while (i < 10);
+;   wrapping(7);
+;   return 0;
+; }
+
+; CHECK-REGISTER: MemoryState: Register BasicBlock counted
+; CHECK-REGISTER: MemoryState: Register BasicBlock wrapping
+; CHECK-REGISTER: KLEE: ERROR: {{\(?[^:\)]*[\):]?}} infinite loop{{$}}
+
+; Both loops are marked llvm.loop.mustprogress (as emitted by clang for C11).
+; Assuming forward progress, ScalarEvolution would bound the wrapping loop
+; as well, although it never terminates for an odd n.
+; CHECK-SKIP-NOT: MemoryState: Register BasicBlock counted
+; CHECK-SKIP: MemoryState: Register BasicBlock wrapping
+; CHECK-SKIP: KLEE: ERROR: {{\(?[^:\)]*[\):]?}} infinite loop{{$}}
+
+define internal void @wrapping(i8 %n) {
+entry:
+  br label %wrapping
+
+wrapping:                                         ; preds = %wrapping, %entry
+  %i = phi i8 [ 0, %entry ], [ %inc, %wrapping ]
+  %inc = add i8 %i, 2
+  %cmp = icmp ne i8 %inc, %n
+  br i1 %cmp, label %wrapping, label %exit, !llvm.loop !0
+
+exit:                                             ; preds = %wrapping
+  ret void
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  br label %counted
+
+counted:                                          ; preds = %counted, %entry
+  %i = phi i32 [ 0, %entry ], [ %inc, %counted ]
+  %inc = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %inc, 10
+  br i1 %cmp, label %counted, label %exit, !llvm.loop !2
+
+exit:                                             ; preds = %counted
+  call void @wrapping(i8 7)
+  ret i32 0
+}
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.mustprogress"}
+!2 = distinct !{!2, !1}
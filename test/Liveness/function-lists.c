@@ -0,0 +1,35 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+
+// --- log_value() modifies a global counter in every iteration
+// RUN: rm -rf %t.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t.bc 2>&1 | not FileCheck %s
+// RUN: not test -f %t.klee-out/test000001.infty.err
+
+// RUN: echo '{"output": ["log_value"]}' > %t.json
+// RUN: rm -rf %t-json.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-json.klee-out -detect-infinite-loops -infinite-loop-detection-function-lists=%t.json -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-json.klee-out/test000001.infty.err
+
+// RUN: echo '{builtins: false, output: [log_value]}' > %t.yaml
+// RUN: rm -rf %t-yaml.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-yaml.klee-out -detect-infinite-loops -infinite-loop-detection-function-lists=%t.yaml -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-yaml.klee-out/test000001.infty.err
+
+#include <klee/klee.h>
+
+static unsigned calls;
+
+void log_value(int value) {
+  ++calls;
+  (void)value;
+}
+
+int main(int argc, char *argv[]) {
+  int x;
+  klee_make_symbolic(&x, sizeof(x), "x");
+
+  // CHECK: KLEE: ERROR: {{[^:]*}}/function-lists.c:{{[0-9]+}}: infinite loop{{$}}
+  while (1) {
+    log_value(x);
+  }
+}
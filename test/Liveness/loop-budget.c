@@ -0,0 +1,57 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+
+// --- the second loop never repeats a state, but exceeds its budget
+// RUN: rm -rf %t-terminate.klee-out
+// RUN: %klee -output-dir=%t-terminate.klee-out -detect-infinite-loops -infinite-loop-detection-max-loop-iterations=100 -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-terminate.klee-out/test000001.suspected_infty.err
+// RUN: FileCheck -check-prefix=CHECK-INFO %s < %t-terminate.klee-out/info
+
+// --- the state is only explored further once no other states are left
+// RUN: rm -rf %t-deprioritize.klee-out
+// RUN: %klee -output-dir=%t-deprioritize.klee-out -detect-infinite-loops -infinite-loop-detection-max-loop-iterations=100 -infinite-loop-detection-suspected-loops=deprioritize -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-deprioritize.klee-out/test000001.suspected_infty.err
+// RUN: FileCheck -check-prefix=CHECK-INFO %s < %t-deprioritize.klee-out/info
+
+// --- without a budget, the loop runs until the instruction limit is hit
+// RUN: rm -rf %t-unlimited.klee-out
+// RUN: %klee -output-dir=%t-unlimited.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck -check-prefix=CHECK-UNLIMITED %s
+// RUN: not test -f %t-unlimited.klee-out/test000001.suspected_infty.err
+
+// the loop is only left by returning from the function
+unsigned long find(unsigned long n) {
+  for (unsigned long i = 0;; ++i) {
+    if (i == n)
+      return i;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  unsigned long sum = 0;
+
+  // within budget
+  for (int i = 0; i < 50; ++i)
+    sum += i;
+
+  // irreducible cycle that is entered twice, each time within budget
+  for (int round = 0; round < 2; ++round) {
+    int j = 0;
+    if (argc > 5)
+      goto b;
+  a:
+    sum += j;
+  b:
+    if (++j < 60)
+      goto a;
+  }
+
+  sum += find(70);
+
+  // CHECK: KLEE: ERROR: {{[^:]*}}/loop-budget.c:{{[0-9]+}}: suspected infinite loop{{$}}
+  // CHECK-UNLIMITED-NOT: suspected infinite loop
+  while (1)
+    ++sum;
+
+  // CHECK-INFO: KLEE: done: suspected infinite loops = 1
+  // CHECK-INFO: KLEE: done: max. iterations of a left loop = 71
+  return (int)sum;
+}
@@ -0,0 +1,28 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee -output-dir=%t.klee-out -use-merge -detect-infinite-loops -infinite-loop-detection-symbolic-write-range=1 -debug-infinite-loop-detection=state:stderr -allocate-determ %t.bc 2>&1 | FileCheck %s
+
+#include "klee/klee.h"
+
+char buffer[100];
+
+void touch(unsigned char i) { buffer[i] = 1; }
+
+int main(int argc, char *argv[]) {
+  unsigned char i;
+  klee_make_symbolic(&i, sizeof(i), "i");
+  klee_assume(i < 100);
+
+  // CHECK: MemoryState: symbolic offset {{.*}} is within [+0, +10)
+  klee_open_merge();
+  if (i < 10)
+    touch(i);
+  klee_close_merge();
+
+  // the merged state may write to any byte of buffer, the range computed by
+  // the first state for the same write does not hold anymore
+  // CHECK: MemoryState: merged state
+  // CHECK: MemoryState: symbolic offset {{.*}} is within [+0, +100)
+  touch(i);
+  return 0;
+}
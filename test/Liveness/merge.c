@@ -0,0 +1,44 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee -output-dir=%t.klee-out -use-merge -debug-log-state-merge -detect-infinite-loops -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t.klee-out/test000001.infty.err
+// RUN: rm -rf %t-cached.klee-out
+// RUN: %klee -output-dir=%t-cached.klee-out -use-merge -debug-log-state-merge -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-chunk-size=8 -infinite-loop-detection-cache-object-contributions -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-cached.klee-out/test000001.infty.err
+
+#include "klee/klee.h"
+
+int main(int argc, char *argv[]) {
+  int x;
+  klee_make_symbolic(&x, sizeof(x), "x");
+
+  int same = 0;
+  int y = 0;
+  char pair[8] = {0};
+
+  klee_open_merge();
+  if (x > 0) {
+    same = 5;
+    y = 1;
+    pair[1] = 1;
+    pair[5] = 1;
+  } else {
+    same = 5;
+    y = 2;
+    pair[1] = 2;
+    pair[5] = 2;
+  }
+  klee_close_merge();
+
+  // CHECK-DAG: identical:
+  // CHECK-DAG: merging {{[0-9]+}}: [+0, +1)
+  // CHECK-DAG: merging [[PAIR:[0-9]+]]: [+1, +2)
+  // CHECK-DAG: merging [[PAIR]]: [+5, +6)
+
+  // the merged state (y is 1 or 2) loops forever
+  // CHECK: KLEE: ERROR: {{[^:]*}}/merge.c:{{[0-9]+}}: infinite loop{{$}}
+  while (y > 0) {
+    y = y;
+  }
+  return same + pair[1];
+}
@@ -19,6 +19,22 @@
 // RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O3.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t-O3.bc 2>&1 | FileCheck %s
 // RUN: test -f %t-O3.klee-out/test000001.infty.err
 
+// --- the loop has a period of 256 iterations, more than half of the budget
+// RUN: rm -rf %t-O2-sampling.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-sampling.klee-out -detect-infinite-loops -infinite-loop-detection-max-frame-entries=64 -infinite-loop-detection-eviction=sampling -max-instructions=100000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-sampling.klee-out/test000001.infty.err
+// the reported period counts evicted basic blocks as well
+// RUN: grep -Eq "^Period: (25[6-9]|2[6-9][0-9]|[3-9][0-9]{2}|[0-9]{4,}) registered basic blocks$" %t-O2-sampling.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O2-oldest.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-oldest.klee-out -detect-infinite-loops -infinite-loop-detection-max-frame-entries=64 -infinite-loop-detection-eviction=oldest -max-instructions=100000 -allocate-determ %t-O2.bc 2>&1 | not FileCheck %s
+// RUN: not test -f %t-O2-oldest.klee-out/test000001.infty.err
+
+// --- the wrapping counter has no computable trip count
+// RUN: rm -rf %t-O2-finite.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-finite.klee-out -detect-infinite-loops -infinite-loop-detection-skip-finite-loops -max-instructions=100000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-finite.klee-out/test000001.infty.err
+
 #include <inttypes.h>
 #include <stdio.h>
 
@@ -20,6 +20,14 @@
 // RUN: %klee -output-dir=%t-O3.klee-out -detect-infinite-loops -allocate-determ -max-instructions=10000 %t-O3.bc 2>&1 | FileCheck %s
 // RUN: test -f %t-O3.klee-out/test000001.infty.err
 
+// RUN: rm -rf %t-O3-compact.klee-out
+// RUN: %klee -output-dir=%t-O3-compact.klee-out -detect-infinite-loops -infinite-loop-detection-compact-trace -allocate-determ -max-instructions=10000 %t-O3.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O3-compact.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O3-brent.klee-out
+// RUN: %klee -output-dir=%t-O3-brent.klee-out -detect-infinite-loops -infinite-loop-detection-algorithm=brent -allocate-determ -max-instructions=10000 %t-O3.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O3-brent.klee-out/test000001.infty.err
+
 int is_odd(unsigned int n);
 
 // returns 1 if n is even, 0 otherwise
@@ -0,0 +1,34 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+
+// --- memset() within the library function fill() is shadowed as well and
+// --- its changes to buffer are registered once it returns
+// RUN: echo '{"library": ["fill"]}' > %t.json
+// RUN: rm -rf %t.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t.klee-out -detect-infinite-loops -infinite-loop-detection-function-lists=%t.json -max-instructions=1000000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: ls %t.klee-out | grep -c infty.err | grep -q 1
+
+#include <klee/klee.h>
+
+#include <string.h>
+
+static unsigned char buffer[16];
+
+void fill(unsigned char c) { memset(buffer, c, sizeof(buffer)); }
+
+int main(int argc, char *argv[]) {
+  int x;
+  klee_make_symbolic(&x, sizeof(x), "x");
+
+  if (x) {
+    // terminates: the state only differs in the contents of buffer
+    while (buffer[0] != 200) {
+      fill(buffer[0] + 1);
+    }
+    return 0;
+  }
+
+  // CHECK: KLEE: ERROR: {{[^:]*}}/shadow-nested.c:{{[0-9]+}}: infinite loop{{$}}
+  while (1) {
+    fill(buffer[0] ^ 1);
+  }
+}
@@ -21,10 +21,43 @@
 // RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O3.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t-O3.bc 2>&1 | FileCheck %s
 // RUN: test -f %t-O3.klee-out/test000001.infty.err
 
+// symbolic expressions hashed by their textual representation (debug mode)
+// RUN: rm -rf %t-O0-text.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-text.klee-out -detect-infinite-loops -infinite-loop-detection-hash-expressions-as-text -max-instructions=100000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-text.klee-out/test000001.infty.err
+
+// only rehash bytes within the feasible range of symbolic offsets
+// RUN: rm -rf %t-O0-range.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-range.klee-out -detect-infinite-loops -infinite-loop-detection-symbolic-write-range=1 -max-instructions=100000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-range.klee-out/test000001.infty.err
+
+// bytes outside of the range of a symbolic write are overwritten later on
+// RUN: %clang %s -emit-llvm -O0 -g -c -DOVERWRITE -o %t-overwrite.bc
+// RUN: rm -rf %t-overwrite.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-overwrite.klee-out -detect-infinite-loops -infinite-loop-detection-symbolic-write-range=64 -max-instructions=100000 -allocate-determ %t-overwrite.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-overwrite.klee-out/test000001.infty.err
+// RUN: rm -rf %t-overwrite-chunk.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-overwrite-chunk.klee-out -detect-infinite-loops -infinite-loop-detection-symbolic-write-range=64 -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-lazy-writes -max-instructions=100000 -allocate-determ %t-overwrite.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-overwrite-chunk.klee-out/test000001.infty.err
+
 #include <inttypes.h>
+#include <string.h>
 #include <klee/klee.h>
 
 int main(int argc, char **argv) {
+#ifdef OVERWRITE
+  // larger than -infinite-loop-detection-symbolic-write-range
+  char buffer[100];
+  memset(buffer, 0, sizeof(buffer));
+  unsigned char i;
+  klee_make_symbolic(&i, sizeof(i), "i");
+  klee_assume(i < 10);
+  for (;;) {
+    buffer[i] = 1;
+    memset(buffer, 0, sizeof(buffer));
+  }
+#endif
+
   int array[3];
   klee_make_symbolic(&array, sizeof(array), "array");
   int x;
@@ -19,6 +19,11 @@
 // RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O3.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t-O3.bc 2>&1 | FileCheck %s
 // RUN: test -f %t-O3.klee-out/test000001.infty.err
 
+// RUN: rm -rf %t-O0-brent.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-brent.klee-out -detect-infinite-loops -infinite-loop-detection-algorithm=brent -max-instructions=100000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-brent.klee-out/test000001.infty.err
+// RUN: grep -q "^Period: [0-9]* registered basic blocks$" %t-O0-brent.klee-out/test000001.infty.err
+
 int main(int argc, char *argv[]) {
   int x = 1;
   // CHECK: KLEE: ERROR: {{[^:]*}}/whiletrue.c:{{[0-9]+}}: infinite loop{{$}}
@@ -0,0 +1,65 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t-O0.bc
+// RUN: %clang %s -emit-llvm -O2 -g -c -o %t-O2.bc
+
+// Every granularity of write hashing has to yield the same detection result
+
+// RUN: rm -rf %t-O0-byte.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-byte.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=byte -max-instructions=1000000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-byte.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O0-chunk.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-chunk.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -max-instructions=1000000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-chunk.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O0-chunk7.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-chunk7.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-chunk-size=7 -max-instructions=1000000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-chunk7.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O2-byte.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-byte.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=byte -max-instructions=1000000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-byte.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O2-chunk.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-chunk.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -max-instructions=1000000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-chunk.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O2-chunk7.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-chunk7.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-chunk-size=7 -max-instructions=1000000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-chunk7.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O0-cached.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-cached.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-chunk-size=7 -infinite-loop-detection-cache-object-contributions -max-instructions=1000000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-cached.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O2-cached.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-cached.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-cache-object-contributions -max-instructions=1000000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-cached.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O0-lazy.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O0-lazy.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=byte -infinite-loop-detection-lazy-writes -max-instructions=1000000 -allocate-determ %t-O0.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O0-lazy.klee-out/test000001.infty.err
+
+// RUN: rm -rf %t-O2-lazy.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-O2-lazy.klee-out -detect-infinite-loops -infinite-loop-detection-write-hashing=chunk -infinite-loop-detection-chunk-size=7 -infinite-loop-detection-lazy-writes -max-instructions=1000000 -allocate-determ %t-O2.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-O2-lazy.klee-out/test000001.infty.err
+
+#include <string.h>
+
+#include <klee/klee.h>
+
+int main(int argc, char *argv[]) {
+  char buffer[4096];
+  unsigned char c;
+  klee_make_symbolic(&c, sizeof(c), "c");
+
+  unsigned i = 0;
+  // CHECK: KLEE: ERROR: {{[^:]*}}/write-hashing.c:{{[0-9]+}}: infinite loop{{$}}
+  while (1) {
+    // bulk write that covers many chunks
+    memset(buffer, 'a', sizeof(buffer));
+    // partial writes within a single chunk (concrete and symbolic)
+    buffer[i + 3] = 'b';
+    buffer[i + 4] = c;
+    i = (i + 1) % 4;
+  }
+}
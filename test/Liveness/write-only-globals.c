@@ -0,0 +1,55 @@
+// RUN: %clang %s -emit-llvm -O0 -g -c -o %t.bc
+// RUN: %clang %s -emit-llvm -O0 -g -c -DEXCLUDE_LOCAL -o %t-local.bc
+// RUN: %clang %s -emit-llvm -O0 -g -c -DEXCLUDE_FORKED -o %t-forked.bc
+
+// --- counter is only written, so it does not influence the execution
+// RUN: rm -rf %t.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t.klee-out -detect-infinite-loops -infinite-loop-detection-ignore-write-only-globals -max-instructions=100000 -allocate-determ %t.bc 2>&1 | FileCheck %s
+// RUN: test -f %t.klee-out/test000001.infty.err
+
+// --- without the option, every iteration has a new fingerprint
+// RUN: rm -rf %t-keep.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-keep.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t.bc 2>&1 | not FileCheck %s
+// RUN: not test -f %t-keep.klee-out/test000001.infty.err
+
+// --- local counter that is excluded explicitly
+// RUN: rm -rf %t-local.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-local.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t-local.bc 2>&1 | FileCheck %s
+// RUN: test -f %t-local.klee-out/test000001.infty.err
+
+// --- local counter that is excluded in only one of two forked states
+// RUN: rm -rf %t-forked.klee-out
+// RUN: %klee -libc=uclibc -posix-runtime -output-dir=%t-forked.klee-out -detect-infinite-loops -max-instructions=100000 -allocate-determ %t-forked.bc 2>&1 | FileCheck -check-prefix=CHECK-FORKED %s
+
+#include <klee/klee.h>
+
+unsigned long counter = 0;
+
+int main(int argc, char *argv[]) {
+  // CHECK: KLEE: ERROR: {{[^:]*}}/write-only-globals.c:{{[0-9]+}}: infinite loop{{$}}
+  // CHECK-FORKED: KLEE: ERROR: {{[^:]*}}/write-only-globals.c:{{[0-9]+}}: infinite loop{{$}}
+  // CHECK-FORKED-NOT: infinite loop
+#if defined(EXCLUDE_FORKED)
+  unsigned long steps = 0;
+  int x;
+  klee_make_symbolic(&x, sizeof(x), "x");
+  if (x)
+    klee_exclude_from_memory_state(&steps);
+
+  while (1) {
+    ++steps;
+  }
+#elif defined(EXCLUDE_LOCAL)
+  unsigned long steps = 0;
+  klee_exclude_from_memory_state(&steps);
+
+  while (1) {
+    ++steps;
+  }
+#else
+  while (1) {
+    ++counter;
+  }
+#endif
+  return 0;
+}
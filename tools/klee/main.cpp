@@ -788,6 +788,7 @@ static const char *modelledExternals[] = {
   "klee_clear_memory_state",
   "klee_enable_memory_state",
   "klee_disable_memory_state",
+  "klee_exclude_from_memory_state",
   "klee_dump_memory_trace",
   "klee_define_fixed_object",
   "klee_get_errno",
@@ -1598,6 +1599,18 @@ int main(int argc, char **argv, char **envp) {
     *theStatisticManager->getStatisticByName("Instructions");
   uint64_t forks =
     *theStatisticManager->getStatisticByName("Forks");
+  uint64_t traceEvictions =
+    *theStatisticManager->getStatisticByName("TraceEvictions");
+  uint64_t traceEvictedEntries =
+    *theStatisticManager->getStatisticByName("TraceEvictedEntries");
+  uint64_t traceTruncatedEntries =
+    *theStatisticManager->getStatisticByName("TraceTruncatedEntries");
+  uint64_t duplicateStates =
+    *theStatisticManager->getStatisticByName("DuplicateStates");
+  uint64_t suspectedLoops =
+    *theStatisticManager->getStatisticByName("SuspectedLoops");
+  uint64_t maxLoopIterations =
+    *theStatisticManager->getStatisticByName("MaxLoopIterations");
 
   handler->getInfoStream()
     << "KLEE: done: explored paths = " << 1 + forks << "\n";
@@ -1613,6 +1626,25 @@ int main(int argc, char **argv, char **envp) {
     << "KLEE: done: valid queries = " << queriesValid << "\n"
     << "KLEE: done: invalid queries = " << queriesInvalid << "\n"
     << "KLEE: done: query cex = " << queryCounterexamples << "\n";
+  if (traceEvictions)
+    handler->getInfoStream()
+      << "KLEE: done: memory trace evictions = " << traceEvictions << "\n"
+      << "KLEE: done: evicted memory trace entries = " << traceEvictedEntries
+      << "\n";
+  if (traceTruncatedEntries)
+    handler->getInfoStream()
+      << "KLEE: done: memory trace entries truncated on loop exit = "
+      << traceTruncatedEntries << "\n";
+  if (duplicateStates)
+    handler->getInfoStream()
+      << "KLEE: done: duplicate states = " << duplicateStates << "\n";
+  if (suspectedLoops)
+    handler->getInfoStream()
+      << "KLEE: done: suspected infinite loops = " << suspectedLoops << "\n";
+  if (maxLoopIterations)
+    handler->getInfoStream()
+      << "KLEE: done: max. iterations of a left loop = " << maxLoopIterations
+      << "\n";
 
   std::stringstream stats;
   stats << "\n";
@@ -264,4 +264,94 @@ TEST(ExprTest, ReadExprFoldingSymbolicIndexUpdate) {
     EXPECT_EQ(Expr::Read, read.get()->getKind());
   }
 }
+
+TEST(ExprTest, ContentHashStructural) {
+  // separate caches yield separate (but structurally equal) arrays
+  ArrayCache ac1, ac2;
+  const Array *array1 = ac1.CreateArray("arr", 256);
+  const Array *array2 = ac2.CreateArray("arr", 256);
+  const Array *other = ac1.CreateArray("other", 256);
+  ASSERT_NE(array1, array2);
+
+  ref<Expr> a = AddExpr::create(Expr::createTempRead(array1, Expr::Int32),
+                                getConstant(5, Expr::Int32));
+  ref<Expr> b = AddExpr::create(Expr::createTempRead(array2, Expr::Int32),
+                                getConstant(5, Expr::Int32));
+  ref<Expr> c = AddExpr::create(Expr::createTempRead(array1, Expr::Int32),
+                                getConstant(6, Expr::Int32));
+  ref<Expr> d = AddExpr::create(Expr::createTempRead(other, Expr::Int32),
+                                getConstant(5, Expr::Int32));
+  ref<Expr> e = SubExpr::create(Expr::createTempRead(array1, Expr::Int32),
+                                getConstant(5, Expr::Int32));
+
+  EXPECT_NE(a.get(), b.get());
+  EXPECT_EQ(a->contentHash(), b->contentHash());
+  EXPECT_NE(a->contentHash(), c->contentHash());
+  EXPECT_NE(a->contentHash(), d->contentHash());
+  EXPECT_NE(a->contentHash(), e->contentHash());
+
+  ref<Expr> read = Expr::createTempRead(array1, Expr::Int32);
+  EXPECT_NE(ExtractExpr::create(read, 0, Expr::Int8)->contentHash(),
+            ExtractExpr::create(read, 8, Expr::Int8)->contentHash());
+  EXPECT_NE(ZExtExpr::create(read, Expr::Int64)->contentHash(),
+            SExtExpr::create(read, Expr::Int64)->contentHash());
+}
+
+TEST(ExprTest, ContentHashLongUpdateList) {
+  ArrayCache ac;
+  const Array *array = ac.CreateArray("arr", 256);
+  const Array *indexArray = ac.CreateArray("index", 4);
+  ref<Expr> symbolicIndex = Expr::createTempRead(indexArray, Expr::Int32);
+
+  const unsigned updates = 10000;
+  UpdateList ul1(array, 0), ul2(array, 0), ul3(array, 0);
+  for (unsigned i = 0; i < updates; ++i) {
+    ref<Expr> value = getConstant(i % 256, Expr::Int8);
+    ul1.extend(symbolicIndex, value);
+    ul2.extend(symbolicIndex, value);
+    ul3.extend(symbolicIndex,
+               i == updates / 2 ? getConstant((i + 1) % 256, Expr::Int8)
+                                : value);
+  }
+
+  ref<Expr> index = getConstant(0, Expr::Int32);
+  ref<Expr> read1 = ReadExpr::create(ul1, index);
+  ref<Expr> read2 = ReadExpr::create(ul2, index);
+  ref<Expr> read3 = ReadExpr::create(ul3, index);
+  EXPECT_EQ(read1->contentHash(), read2->contentHash());
+  EXPECT_NE(read1->contentHash(), read3->contentHash());
+
+  // extending a list only requires hashing the new update
+  ul1.extend(symbolicIndex, getConstant(1, Expr::Int8));
+  ul2.extend(symbolicIndex, getConstant(2, Expr::Int8));
+  EXPECT_NE(ReadExpr::create(ul1, index)->contentHash(),
+            ReadExpr::create(ul2, index)->contentHash());
+}
+
+TEST(ExprTest, ContentHashDeepExpression) {
+  ArrayCache ac;
+  const Array *array = ac.CreateArray("arr", 4);
+  ref<Expr> read = Expr::createTempRead(array, Expr::Int32);
+
+  // Deep enough to overflow the call stack if kids were hashed recursively.
+  // All nodes are kept, so that they are destroyed one by one from the top.
+  const unsigned depth = 200000;
+  std::vector<ref<Expr>> chain1(1, read), chain2(1, read);
+  for (unsigned i = 0; i < depth; ++i) {
+    chain1.push_back(AddExpr::alloc(chain1.back(), read));
+    chain2.push_back(AddExpr::alloc(
+        chain2.back(), i == 0 ? getConstant(1, Expr::Int32) : read));
+  }
+
+  EXPECT_NE(chain1.back()->contentHash(), chain2.back()->contentHash());
+  // hashes of all nested expressions have been cached
+  EXPECT_TRUE(chain1[depth / 2]->hasContentHash());
+  EXPECT_EQ(chain1[1]->contentHash(),
+            AddExpr::alloc(read, read)->contentHash());
+
+  while (!chain1.empty())
+    chain1.pop_back();
+  while (!chain2.empty())
+    chain2.pop_back();
+}
 }
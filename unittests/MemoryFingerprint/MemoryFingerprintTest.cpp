@@ -0,0 +1,269 @@
+//===-- MemoryFingerprintTest.cpp -----------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "Core/MemoryFingerprint.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+const InfiniteLoopDetectionFingerprintType backends[] = {FINGERPRINT_BLAKE2B,
+                                                         FINGERPRINT_FAST128};
+
+// restores the selected backend after each test
+class MemoryFingerprintTest : public ::testing::Test {
+protected:
+  InfiniteLoopDetectionFingerprintType savedFingerprint;
+
+  void SetUp() override { savedFingerprint = InfiniteLoopDetectionFingerprint; }
+  void TearDown() override {
+    InfiniteLoopDetectionFingerprint = savedFingerprint;
+  }
+};
+
+// same sequence of updates as a concrete byte written by MemoryState
+template <typename T>
+void writeByte(T &fingerprint, std::uint64_t address, std::uint8_t value) {
+  fingerprint.updateUint8(1);
+  fingerprint.updateUint64(address);
+  fingerprint.updateUint8(value);
+  fingerprint.applyToFingerprint();
+}
+
+TEST_F(MemoryFingerprintTest, OrderIndependent) {
+  for (auto backend : backends) {
+    InfiniteLoopDetectionFingerprint = backend;
+
+    MemoryFingerprint a, b;
+    writeByte(a, 0x1000, 1);
+    writeByte(a, 0x1001, 2);
+    writeByte(b, 0x1001, 2);
+    writeByte(b, 0x1000, 1);
+    EXPECT_EQ(a.getFingerprint(), b.getFingerprint());
+  }
+}
+
+TEST_F(MemoryFingerprintTest, Removable) {
+  for (auto backend : backends) {
+    InfiniteLoopDetectionFingerprint = backend;
+
+    MemoryFingerprint a;
+    MemoryFingerprint::fingerprint_t empty = a.getFingerprint();
+    writeByte(a, 0x1000, 1);
+    MemoryFingerprint::fingerprint_t one = a.getFingerprint();
+    EXPECT_NE(empty, one);
+    writeByte(a, 0x1001, 2);
+    EXPECT_NE(one, a.getFingerprint());
+    // registering the same write again removes it from the fingerprint
+    writeByte(a, 0x1001, 2);
+    EXPECT_EQ(one, a.getFingerprint());
+    writeByte(a, 0x1000, 1);
+    EXPECT_EQ(empty, a.getFingerprint());
+  }
+}
+
+TEST_F(MemoryFingerprintTest, CachedDeltaEqualsLocalDelta) {
+  for (auto backend : backends) {
+    InfiniteLoopDetectionFingerprint = backend;
+
+    // live local applied to a copy (as MemoryState did before caching)
+    MemoryFingerprint a;
+    writeByte(a, 0x1000, 1);
+    MemoryFingerprint copy = a;
+    copy.updateUint8(3);
+    copy.updateUint64(0x2000);
+    copy.updateUint64(42);
+    copy.applyToFingerprintLocalDelta();
+
+    // same live local as cached contribution
+    MemoryFingerprint::fingerprint_t delta;
+    a.updateUint8(3);
+    a.updateUint64(0x2000);
+    a.updateUint64(42);
+    a.generateDelta(delta);
+    MemoryFingerprint::fingerprint_t result = a.getFingerprint();
+    MemoryFingerprint::applyDelta(result, delta);
+
+    EXPECT_EQ(copy.getFingerprint(), result);
+    // generating a delta leaves the fingerprint itself unchanged
+    MemoryFingerprint b;
+    writeByte(b, 0x1000, 1);
+    EXPECT_EQ(b.getFingerprint(), a.getFingerprint());
+  }
+}
+
+TEST_F(MemoryFingerprintTest, Distinguishes) {
+  for (auto backend : backends) {
+    InfiniteLoopDetectionFingerprint = backend;
+
+    MemoryFingerprint a, b, c;
+    writeByte(a, 0x1000, 1);
+    writeByte(b, 0x1000, 2);
+    writeByte(c, 0x1001, 1);
+    EXPECT_NE(a.getFingerprint(), b.getFingerprint());
+    EXPECT_NE(a.getFingerprint(), c.getFingerprint());
+    EXPECT_NE(b.getFingerprint(), c.getFingerprint());
+  }
+}
+
+TEST_F(MemoryFingerprintTest, UpdateBytesEqualsSingleBytes) {
+  const std::uint8_t bytes[] = {0, 1, 2, 0xff, 0x80, 42, 7, 0};
+  for (auto backend : backends) {
+    InfiniteLoopDetectionFingerprint = backend;
+
+    MemoryFingerprint a, b;
+    a.updateUint8(8);
+    a.updateBytes(bytes, sizeof(bytes));
+    a.applyToFingerprint();
+    b.updateUint8(8);
+    for (std::uint8_t byte : bytes)
+      b.updateUint8(byte);
+    b.applyToFingerprint();
+    EXPECT_EQ(a.getFingerprint(), b.getFingerprint());
+  }
+}
+
+TEST_F(MemoryFingerprintTest, Fast128UsesLowerHalf) {
+  InfiniteLoopDetectionFingerprint = FINGERPRINT_FAST128;
+
+  MemoryFingerprint a;
+  writeByte(a, 0x1000, 1);
+  MemoryFingerprint::fingerprint_t fp = a.getFingerprint();
+  for (std::size_t i = 16; i < fp.size(); ++i) {
+    EXPECT_EQ(fp[i], 0);
+  }
+}
+
+// 128-bit fast128 hash of size bytes
+MemoryFingerprint::fingerprint_t fast128(const std::uint8_t *bytes,
+                                         std::size_t size) {
+  MemoryFingerprint fingerprint;
+  MemoryFingerprint::fingerprint_t result;
+  fingerprint.updateBytes(bytes, size);
+  fingerprint.generateDelta(result);
+  return result;
+}
+
+bool getBit(const MemoryFingerprint::fingerprint_t &fp, std::size_t bit) {
+  return (fp[bit / 8] >> (bit % 8)) & 1;
+}
+
+TEST_F(MemoryFingerprintTest, Fast128Avalanche) {
+  InfiniteLoopDetectionFingerprint = FINGERPRINT_FAST128;
+
+  // Flipping any input bit has to flip every output bit with probability
+  // 1/2. With 1000 samples, the standard deviation of the observed
+  // frequency is below 0.016, so the bounds are more than 6 sigma away.
+  // Input sizes: a written byte, a live register, a chunk of 64 bytes.
+  const std::size_t samples = 1000;
+  std::mt19937_64 rng(42);
+  for (std::size_t size : {10, 17, 73}) {
+    std::vector<std::uint8_t> input(size);
+    for (std::size_t inBit = 0; inBit < size * 8; ++inBit) {
+      std::size_t flips[128] = {};
+      for (std::size_t i = 0; i < samples; ++i) {
+        for (std::uint8_t &byte : input)
+          byte = static_cast<std::uint8_t>(rng());
+        MemoryFingerprint::fingerprint_t a = fast128(input.data(), size);
+        input[inBit / 8] ^= 1u << (inBit % 8);
+        MemoryFingerprint::fingerprint_t b = fast128(input.data(), size);
+        for (std::size_t outBit = 0; outBit < 128; ++outBit)
+          flips[outBit] += getBit(a, outBit) != getBit(b, outBit);
+      }
+      for (std::size_t outBit = 0; outBit < 128; ++outBit) {
+        EXPECT_GE(flips[outBit], samples * 4 / 10)
+            << "size " << size << ", input bit " << inBit << ", output bit "
+            << outBit;
+        EXPECT_LE(flips[outBit], samples * 6 / 10)
+            << "size " << size << ", input bit " << inBit << ", output bit "
+            << outBit;
+      }
+    }
+  }
+}
+
+TEST_F(MemoryFingerprintTest, Fast128Distribution) {
+  InfiniteLoopDetectionFingerprint = FINGERPRINT_FAST128;
+
+  // highly structured inputs as produced by consecutive writes
+  const std::size_t inputs = 1 << 16;
+  std::size_t lowBuckets[256] = {}, highBuckets[256] = {};
+  std::set<std::pair<std::uint64_t, std::uint64_t>> hashes;
+  for (std::uint64_t i = 0; i < inputs; ++i) {
+    MemoryFingerprint a;
+    writeByte(a, 0x1000 + i, static_cast<std::uint8_t>(i));
+    MemoryFingerprint::fingerprint_t fp = a.getFingerprint();
+    ++lowBuckets[fp[0]];
+    ++highBuckets[fp[15]];
+    std::uint64_t lo, hi;
+    std::memcpy(&lo, fp.data(), sizeof(lo));
+    std::memcpy(&hi, fp.data() + sizeof(lo), sizeof(hi));
+    hashes.emplace(lo, hi);
+  }
+  EXPECT_EQ(hashes.size(), inputs);
+
+  // 256 expected per bucket with a standard deviation of 16
+  for (std::size_t bucket = 0; bucket < 256; ++bucket) {
+    EXPECT_GE(lowBuckets[bucket], 176u) << "bucket " << bucket;
+    EXPECT_LE(lowBuckets[bucket], 336u) << "bucket " << bucket;
+    EXPECT_GE(highBuckets[bucket], 176u) << "bucket " << bucket;
+    EXPECT_LE(highBuckets[bucket], 336u) << "bucket " << bucket;
+  }
+}
+
+// Micro-benchmark comparing the available backends on tiny updates as they
+// are performed for every written byte. Run explicitly with
+// --gtest_also_run_disabled_tests.
+template <typename T>
+double measure(T &fingerprint, std::uint64_t iterations) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::uint64_t i = 0; i < iterations; ++i) {
+    writeByte(fingerprint, 0x1000 + i, static_cast<std::uint8_t>(i));
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+TEST_F(MemoryFingerprintTest, DISABLED_Benchmark) {
+  const std::uint64_t iterations = 10000000;
+
+  MemoryFingerprint_CryptoPP_BLAKE2b incremental;
+  llvm::outs() << "CryptoPP_BLAKE2b:     " << measure(incremental, iterations)
+               << " ns/write\n";
+
+  InfiniteLoopDetectionFingerprint = FINGERPRINT_BLAKE2B;
+  MemoryFingerprint blake2b;
+  llvm::outs() << "Selectable (blake2b): " << measure(blake2b, iterations)
+               << " ns/write\n";
+
+  InfiniteLoopDetectionFingerprint = FINGERPRINT_FAST128;
+  MemoryFingerprint fast128;
+  llvm::outs() << "Selectable (fast128): " << measure(fast128, iterations)
+               << " ns/write\n";
+
+  MemoryFingerprint_Dummy dummy;
+  llvm::outs() << "Dummy:                " << measure(dummy, iterations / 100)
+               << " ns/write\n";
+}
+
+} // namespace
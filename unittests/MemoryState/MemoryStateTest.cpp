@@ -0,0 +1,274 @@
+//===-- MemoryStateTest.cpp -----------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#define KLEE_UNITTEST
+
+#include "gtest/gtest.h"
+
+#include "Core/Context.h"
+#include "Core/ExecutionState.h"
+#include "Core/Memory.h"
+#include "Core/MemoryState.h"
+#include "klee/Expr/ArrayCache.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Support/InfiniteLoopDetectionFlags.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+struct WriteHashingMode {
+  InfiniteLoopDetectionWriteHashingType hashing;
+  unsigned chunkSize;
+  bool cache;
+  bool lazy;
+};
+
+const WriteHashingMode modes[] = {
+    {HASH_WRITES_PER_BYTE, 64, false, false},
+    {HASH_WRITES_PER_BYTE, 64, false, true},
+    {HASH_WRITES_PER_CHUNK, 64, false, false},
+    {HASH_WRITES_PER_CHUNK, 8, false, false},
+    {HASH_WRITES_PER_CHUNK, 7, true, false},
+    {HASH_WRITES_PER_CHUNK, 8, false, true},
+    {HASH_WRITES_PER_CHUNK, 8, true, true},
+};
+
+class MemoryStateTest : public ::testing::Test {
+protected:
+  InfiniteLoopDetectionWriteHashingType savedHashing;
+  unsigned savedChunkSize;
+  bool savedCache;
+  bool savedLazy;
+
+  static void SetUpTestCase() { Context::initialize(true, Expr::Int64); }
+
+  void SetUp() override {
+    savedHashing = InfiniteLoopDetectionWriteHashing;
+    savedChunkSize = InfiniteLoopDetectionChunkSize;
+    savedCache = InfiniteLoopDetectionCacheObjectContributions;
+    savedLazy = InfiniteLoopDetectionLazyWrites;
+  }
+
+  void TearDown() override {
+    InfiniteLoopDetectionWriteHashing = savedHashing;
+    InfiniteLoopDetectionChunkSize = savedChunkSize;
+    InfiniteLoopDetectionCacheObjectContributions = savedCache;
+    InfiniteLoopDetectionLazyWrites = savedLazy;
+  }
+
+  static void setMode(const WriteHashingMode &mode) {
+    InfiniteLoopDetectionWriteHashing = mode.hashing;
+    InfiniteLoopDetectionChunkSize = mode.chunkSize;
+    InfiniteLoopDetectionCacheObjectContributions = mode.cache;
+    InfiniteLoopDetectionLazyWrites = mode.lazy;
+  }
+};
+
+// Writes to a global object as performed by Executor::executeMemoryOperation()
+class WriteSequence {
+  ExecutionState state;
+  const MemoryObject *mo;
+  ObjectState *os;
+
+public:
+  std::vector<MemoryFingerprint::fingerprint_t> fingerprints;
+
+  explicit WriteSequence(unsigned size) {
+    mo = new MemoryObject(0x1000, size, false, true, false, nullptr, 0,
+                          nullptr);
+    os = new ObjectState(mo);
+    os->initializeToZero();
+    state.addressSpace.bindObject(mo, os);
+    state.memoryState.enable();
+    snapshot();
+    state.memoryState.registerWrite(mo->getBaseExpr(), *mo, *os);
+    snapshot();
+  }
+
+  void snapshot() {
+    fingerprints.push_back(state.memoryState.getFingerprint());
+  }
+
+  void write(unsigned offset, ref<Expr> value) {
+    ref<Expr> address = AddExpr::create(
+        mo->getBaseExpr(), ConstantExpr::create(offset, Expr::Int64));
+    std::size_t bytes = value->getWidth() / 8;
+    state.memoryState.unregisterWrite(address, *mo, *os, bytes);
+    os->write(offset, value);
+    state.memoryState.registerWrite(address, *mo, *os, bytes);
+    snapshot();
+  }
+
+  // write with a symbolic offset whose feasible range is [begin, end), as
+  // bounded by Executor::boundSymbolicWrite()
+  void write(ref<Expr> offset, ref<Expr> value, std::uint64_t begin,
+             std::uint64_t end) {
+    ref<Expr> address = AddExpr::create(mo->getBaseExpr(), offset);
+    std::size_t bytes = value->getWidth() / 8;
+    state.memoryState.setSymbolicWriteRange(mo->getOffsetExpr(address), begin,
+                                            end + bytes);
+    state.memoryState.unregisterWrite(address, *mo, *os, bytes);
+    os->write(mo->getOffsetExpr(address), value);
+    state.memoryState.registerWrite(address, *mo, *os, bytes);
+    snapshot();
+  }
+
+  // as memset(), which is modeled to modify the whole object
+  void fill(std::uint8_t value) {
+    state.memoryState.unregisterWrite(*mo, *os);
+    for (unsigned i = 0; i < mo->size; ++i)
+      os->write8(i, value);
+    state.memoryState.registerWrite(mo->getBaseExpr(), *mo, *os);
+    snapshot();
+  }
+
+  // as Executor::executeFree(), the object must not be used afterwards
+  void free() {
+    state.memoryState.unregisterWrite(*mo, *os);
+    state.addressSpace.unbindObject(mo);
+    snapshot();
+  }
+};
+
+TEST_F(MemoryStateTest, WriteHashingModesAreEquivalent) {
+  ArrayCache cache;
+  const Array *array = cache.CreateArray("sym", 4);
+  ref<Expr> sym = Expr::createTempRead(array, Expr::Int8);
+  ref<Expr> sym32 = Expr::createTempRead(array, Expr::Int32);
+
+  std::vector<std::vector<MemoryFingerprint::fingerprint_t>> results;
+  for (const WriteHashingMode &mode : modes) {
+    setMode(mode);
+
+    WriteSequence seq(100);
+    seq.write(3, ConstantExpr::create(1, Expr::Int8));      // 2
+    seq.write(3, ConstantExpr::create(0, Expr::Int8));      // 3: same as 1
+    seq.write(10, ConstantExpr::create(-1, Expr::Int64));   // 4
+    seq.write(5, sym);                                      // 5
+    seq.write(10, ConstantExpr::create(0, Expr::Int64));    // 6
+    seq.write(5, ConstantExpr::create(0, Expr::Int8));      // 7: same as 1
+    seq.write(62, sym32);                                   // 8: spans chunks
+    seq.write(5, sym);                                      // 9
+    seq.write(5, ConstantExpr::create(0, Expr::Int8));      // 10: same as 8
+    seq.write(62, ConstantExpr::create(0, Expr::Int32));    // 11: same as 1
+    seq.write(99, ConstantExpr::create(7, Expr::Int8));     // 12
+    seq.write(2, ConstantExpr::create(7, Expr::Int8));      // 13
+    seq.write(99, ConstantExpr::create(0, Expr::Int8));     // 14
+    seq.write(2, ConstantExpr::create(0, Expr::Int8));      // 15: same as 1
+    seq.free();                                             // 16: same as 0
+    results.push_back(seq.fingerprints);
+  }
+
+  // expected outcomes of comparisons within the sequence
+  const std::vector<MemoryFingerprint::fingerprint_t> &fps = results.front();
+  EXPECT_NE(fps[0], fps[1]);
+  EXPECT_NE(fps[1], fps[2]);
+  EXPECT_EQ(fps[1], fps[3]);
+  EXPECT_NE(fps[4], fps[5]);
+  EXPECT_EQ(fps[1], fps[7]);
+  EXPECT_EQ(fps[8], fps[10]);
+  EXPECT_NE(fps[12], fps[13]);
+  EXPECT_EQ(fps[1], fps[15]);
+  EXPECT_EQ(fps[0], fps[16]);
+
+  // every mode has to decide every comparison in the same way
+  for (std::size_t m = 1; m < results.size(); ++m) {
+    ASSERT_EQ(results[m].size(), fps.size());
+    for (std::size_t i = 0; i < fps.size(); ++i) {
+      for (std::size_t j = 0; j < i; ++j) {
+        EXPECT_EQ(fps[i] == fps[j], results[m][i] == results[m][j])
+            << "mode " << m << ", fingerprints " << j << " and " << i;
+      }
+    }
+  }
+}
+
+TEST_F(MemoryStateTest, SymbolicWriteRangeLeavesNoStaleContribution) {
+  ArrayCache cache;
+  const Array *array = cache.CreateArray("index", 1);
+  ref<Expr> index =
+      ZExtExpr::create(Expr::createTempRead(array, Expr::Int8), Expr::Int64);
+  ref<Expr> one = ConstantExpr::create(1, Expr::Int8);
+
+  for (const WriteHashingMode &mode : modes) {
+    setMode(mode);
+
+    // for (;;) { a[index] = 1; memset(a, 0, sizeof(a)); } with index < 10
+    WriteSequence seq(100);
+    seq.write(index, one, 0, 9); // 2
+    seq.fill(0);                 // 3: same as 1
+    seq.write(index, one, 0, 9); // 4
+    seq.fill(0);                 // 5: same as 1
+    seq.free();                  // 6: same as 0
+
+    const std::vector<MemoryFingerprint::fingerprint_t> &fps = seq.fingerprints;
+    EXPECT_NE(fps[1], fps[2]);
+    EXPECT_EQ(fps[1], fps[3]);
+    EXPECT_EQ(fps[1], fps[5]);
+    EXPECT_EQ(fps[0], fps[6]);
+  }
+}
+
+// Writes to the object of a global in a state as performed by
+// Executor::executeMemoryOperation()
+void writeByte(ExecutionState &state, const MemoryObject *mo, unsigned offset,
+               std::uint8_t value) {
+  ref<Expr> address = AddExpr::create(
+      mo->getBaseExpr(), ConstantExpr::create(offset, Expr::Int64));
+  const ObjectState *os = state.addressSpace.findObject(mo);
+  state.memoryState.unregisterWrite(address, *mo, *os, 1);
+  ObjectState *wos = state.addressSpace.getWriteable(mo, os);
+  wos->write8(offset, value);
+  state.memoryState.registerWrite(address, *mo, *wos, 1);
+}
+
+TEST_F(MemoryStateTest, MergeRehashesChunksOnce) {
+  ArrayCache cache;
+  const Array *array = cache.CreateArray("x", 1);
+  ref<Expr> x = Expr::createTempRead(array, Expr::Int8);
+  ref<Expr> zero = ConstantExpr::create(0, Expr::Int8);
+
+  for (const WriteHashingMode &mode : modes) {
+    setMode(mode);
+
+    ExecutionState a;
+    a.memoryState.enable();
+    MemoryFingerprint::fingerprint_t empty = a.memoryState.getFingerprint();
+
+    auto *mo = new MemoryObject(0x1000, 16, false, true, false, nullptr, 0,
+                                nullptr);
+    auto *os = new ObjectState(mo);
+    os->initializeToZero();
+    a.addressSpace.bindObject(mo, os);
+    a.memoryState.registerWrite(mo->getBaseExpr(), *mo, *os);
+
+    // two non-adjacent differing bytes within the same chunk
+    ExecutionState *b = a.branch();
+    a.addConstraint(EqExpr::create(x, zero));
+    writeByte(a, mo, 1, 1);
+    writeByte(a, mo, 5, 1);
+    b->addConstraint(NeExpr::create(x, zero));
+    writeByte(*b, mo, 1, 2);
+    writeByte(*b, mo, 5, 2);
+
+    ASSERT_TRUE(a.merge(*b));
+    delete b;
+
+    // as Executor::executeFree(), nothing is left of the merged object
+    const ObjectState *merged = a.addressSpace.findObject(mo);
+    a.memoryState.unregisterWrite(*mo, *merged);
+    a.addressSpace.unbindObject(mo);
+    EXPECT_EQ(empty, a.memoryState.getFingerprint());
+  }
+}
+
+} // namespace
@@ -9,12 +9,16 @@
 
 #include "../lib/Module/Passes.h"
 
+#include "klee/Config/Version.h"
+
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 
 #include "../parseAssembly.h"
 #include "gtest/gtest.h"
 
+#include <set>
+
 using namespace llvm;
 
 namespace klee {
@@ -168,4 +172,206 @@ TEST_F(LiveRegisterPassTest, GetLiveSet) {
   ASSERT_TRUE(validLiveSets == 0);
 }
 
+TEST_F(LiveRegisterPassTest, LoopHeaders) {
+  // twophi and onephi form an irreducible cycle (both are entered from entry)
+  LoopHeaderPass lhp;
+  lhp.runOnFunction(*testFunction);
+
+  ASSERT_EQ(lhp.getNumberOfLoopHeaders(), 1u);
+  for (auto &bb : *testFunction) {
+    ASSERT_EQ(lhp.isLoopHeader(&bb), bb.getName() == "twophi");
+    const auto *cycle = lhp.getIrreducibleCycle(&bb);
+    if (bb.getName() != "twophi") {
+      ASSERT_EQ(cycle, nullptr);
+      continue;
+    }
+    ASSERT_NE(cycle, nullptr);
+    std::set<StringRef> names;
+    for (const BasicBlock *member : *cycle)
+      names.insert(member->getName());
+    ASSERT_EQ(names, std::set<StringRef>({"twophi", "onephi"}));
+  }
+}
+
+TEST(LoopHeaderPassTest, NaturalLoops) {
+  LLVMContext Ctx;
+  StringRef Source = "define void @test(i64 %n) {\n"
+                     "entry:\n"
+                     "  br label %outer\n"
+                     "\n"
+                     "outer:\n"
+                     "  %i = phi i64 [ 0, %entry ], [ %i1, %latch ]\n"
+                     "  br label %inner\n"
+                     "\n"
+                     "inner:\n"
+                     "  %j = phi i64 [ 0, %outer ], [ %j1, %inner ]\n"
+                     "  %j1 = add i64 %j, 1\n"
+                     "  %cmp1 = icmp ult i64 %j1, %n\n"
+                     "  br i1 %cmp1, label %inner, label %latch\n"
+                     "\n"
+                     "latch:\n"
+                     "  %i1 = add i64 %i, 1\n"
+                     "  %cmp2 = icmp ult i64 %i1, %n\n"
+                     "  br i1 %cmp2, label %join, label %exit\n"
+                     "\n"
+                     "join:\n"
+                     "  br label %outer\n"
+                     "\n"
+                     "exit:\n"
+                     "  ret void\n"
+                     "}";
+  std::unique_ptr<Module> m = parseAssembly(Ctx, Source);
+  Function *f = m->getFunction("test");
+
+  LoopHeaderPass lhp;
+  lhp.runOnFunction(*f);
+
+  ASSERT_EQ(lhp.getNumberOfLoopHeaders(), 2u);
+  for (auto &bb : *f) {
+    bool header = bb.getName() == "outer" || bb.getName() == "inner";
+    ASSERT_EQ(lhp.isLoopHeader(&bb), header);
+    ASSERT_EQ(lhp.getIrreducibleCycle(&bb), nullptr);
+  }
+}
+
+TEST(FiniteLoopPassTest, CountedLoops) {
+  LLVMContext Ctx;
+  StringRef Source = "define void @test(i64 %n, i64* %p) {\n"
+                     "entry:\n"
+                     "  br label %outer\n"
+                     "\n"
+                     "outer:\n"
+                     "  br label %inner\n"
+                     "\n"
+                     "inner:\n"
+                     "  %j = phi i64 [ 0, %outer ], [ %j1, %inner ]\n"
+                     "  %j1 = add nuw i64 %j, 1\n"
+                     "  %cmp1 = icmp ult i64 %j1, %n\n"
+                     "  br i1 %cmp1, label %inner, label %latch\n"
+                     "\n"
+                     "latch:\n"
+                     "  %v = load i64, i64* %p\n"
+                     "  %cmp2 = icmp eq i64 %v, 0\n"
+                     "  br i1 %cmp2, label %outer, label %exit\n"
+                     "\n"
+                     "exit:\n"
+                     "  ret void\n"
+                     "}";
+  std::unique_ptr<Module> m = parseAssembly(Ctx, Source);
+  Function *f = m->getFunction("test");
+
+  FiniteLoopPass flp;
+  flp.runOnFunction(*f);
+
+  for (auto &bb : *f) {
+    ASSERT_EQ(flp.isInFiniteLoop(&bb), bb.getName() == "inner");
+  }
+}
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(12, 0)
+TEST(FiniteLoopPassTest, MustProgress) {
+  LLVMContext Ctx;
+  // %wrapping never terminates for an odd %n, but would be bounded by
+  // ScalarEvolution if it assumed forward progress
+  StringRef Source = "define void @test(i8 %n) mustprogress {\n"
+                     "entry:\n"
+                     "  br label %counted\n"
+                     "\n"
+                     "counted:\n"
+                     "  %i = phi i32 [ 0, %entry ], [ %i1, %counted ]\n"
+                     "  %i1 = add nsw i32 %i, 1\n"
+                     "  %cmp1 = icmp slt i32 %i1, 10\n"
+                     "  br i1 %cmp1, label %counted, label %wrapping, "
+                     "!llvm.loop !0\n"
+                     "\n"
+                     "wrapping:\n"
+                     "  %j = phi i8 [ 0, %counted ], [ %j1, %wrapping ]\n"
+                     "  %j1 = add i8 %j, 2\n"
+                     "  %cmp2 = icmp ne i8 %j1, %n\n"
+                     "  br i1 %cmp2, label %wrapping, label %exit, "
+                     "!llvm.loop !2\n"
+                     "\n"
+                     "exit:\n"
+                     "  ret void\n"
+                     "}\n"
+                     "\n"
+                     "!0 = distinct !{!0, !1}\n"
+                     "!1 = !{!\"llvm.loop.mustprogress\"}\n"
+                     "!2 = distinct !{!2, !1}";
+  std::unique_ptr<Module> m = parseAssembly(Ctx, Source);
+  Function *f = m->getFunction("test");
+  std::vector<MDNode *> loopIDs;
+  for (auto &bb : *f)
+    loopIDs.push_back(bb.getTerminator()->getMetadata("llvm.loop"));
+
+  FiniteLoopPass flp;
+  flp.runOnFunction(*f);
+
+  for (auto &bb : *f) {
+    ASSERT_EQ(flp.isInFiniteLoop(&bb), bb.getName() == "counted");
+  }
+
+  // the function is left unchanged
+  ASSERT_TRUE(f->hasFnAttribute(Attribute::MustProgress));
+  std::size_t i = 0;
+  for (auto &bb : *f) {
+    ASSERT_EQ(bb.getTerminator()->getMetadata("llvm.loop"), loopIDs[i++]);
+  }
+}
+#endif
+
+TEST(WriteOnlyGlobalPassTest, Counters) {
+  LLVMContext Ctx;
+  StringRef Source = "@counter = global i64 0\n"
+                     "@read = global i64 0\n"
+                     "@escaped = global i64 0\n"
+                     "@volatile = global i64 0\n"
+                     "@constant = constant i64 0\n"
+                     "@ptr = global i64* null\n"
+                     "@divisor = global i64 1\n"
+                     "@dividend = global i64 0\n"
+                     "\n"
+                     "define i64 @test() {\n"
+                     "entry:\n"
+                     "  %c = load i64, i64* @counter\n"
+                     "  %c1 = add i64 %c, 1\n"
+                     "  store i64 %c1, i64* @counter\n"
+                     "  %r = load i64, i64* @read\n"
+                     "  %r1 = add i64 %r, 1\n"
+                     "  store i64 %r1, i64* @read\n"
+                     "  store i64* @escaped, i64** @ptr\n"
+                     "  store volatile i64 1, i64* @volatile\n"
+                     "  %d = load i64, i64* @divisor\n"
+                     "  %d1 = udiv i64 1, %d\n"
+                     "  store i64 %d1, i64* @divisor\n"
+                     "  %n = load i64, i64* @dividend\n"
+                     "  %n1 = udiv i64 %n, 2\n"
+                     "  store i64 %n1, i64* @dividend\n"
+                     "  %k = load i64, i64* @constant\n"
+                     "  %sum = add i64 %r1, %k\n"
+                     "  ret i64 %sum\n"
+                     "}";
+  std::unique_ptr<Module> m = parseAssembly(Ctx, Source);
+
+  WriteOnlyGlobalPass wogp;
+  wogp.runOnModule(*m);
+
+  // @ptr is never loaded, a division by @divisor may trap
+  ASSERT_EQ(wogp.getNumberOfWriteOnlyGlobals(), 3u);
+  ASSERT_TRUE(wogp.isWriteOnly(m->getGlobalVariable("counter")));
+  ASSERT_TRUE(wogp.isWriteOnly(m->getGlobalVariable("ptr")));
+  ASSERT_TRUE(wogp.isWriteOnly(m->getGlobalVariable("dividend")));
+  ASSERT_FALSE(wogp.isWriteOnly(m->getGlobalVariable("divisor")));
+  ASSERT_FALSE(wogp.isWriteOnly(m->getGlobalVariable("read")));
+  ASSERT_FALSE(wogp.isWriteOnly(m->getGlobalVariable("escaped")));
+  ASSERT_FALSE(wogp.isWriteOnly(m->getGlobalVariable("volatile")));
+  ASSERT_FALSE(wogp.isWriteOnly(m->getGlobalVariable("constant")));
+
+  for (auto &inst : m->getFunction("test")->getEntryBlock()) {
+    bool value = inst.getName() == "c" || inst.getName() == "c1" ||
+                 inst.getName() == "n" || inst.getName() == "n1";
+    ASSERT_EQ(wogp.isWriteOnlyValue(&inst), value);
+  }
+}
+
 } // namespace klee
@@ -10,7 +10,9 @@
 
 #include "gtest/gtest.h"
 
+#include "klee/ADT/DiscretePDF.h"
 #include "klee/ADT/RNG.h"
+#include "klee/Module/KInstruction.h"
 #include "Core/ExecutionState.h"
 #include "Core/PTree.h"
 #include "Core/Searcher.h"
@@ -201,6 +203,79 @@ TEST(SearcherTest, TwoRandomPathDot) {
   processTree.remove(es1.ptreeNode);
   processTree.remove(root.ptreeNode);
 }
+
+TEST(SearcherTest, LivenessFavorsRevisits) {
+  ExecutionState revisiting;
+  ExecutionState cleared(revisiting);
+
+  KInstruction ki;
+  ki.operands = nullptr;
+  MemoryFingerprint::fingerprint_t fingerprint = {};
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    // the same basic block with a different fingerprint
+    fingerprint[0] = i;
+    revisiting.memoryState.registerBasicBlock(&ki, fingerprint);
+    cleared.memoryState.registerBasicBlock(&ki, fingerprint);
+  }
+  // e.g. by an input function
+  cleared.memoryState.clearEverything();
+
+  RNG rng;
+  WeightedRandomSearcher ws(WeightedRandomSearcher::Liveness, rng);
+  EXPECT_GT(ws.getWeight(&revisiting), ws.getWeight(&cleared));
+}
+
+TEST(SearcherTest, DeprioritizeDuplicates) {
+  ExecutionState es;
+  ExecutionState es1(es);
+  ExecutionState es2(es);
+
+  DeprioritizingSearcher ds(new DFSSearcher());
+  EXPECT_TRUE(ds.empty());
+
+  ds.update(nullptr, {&es, &es1}, {});
+  EXPECT_EQ(&ds.selectState(), &es1);
+
+  // duplicate is paused as long as other states are left
+  es1.deprioritize = true;
+  ds.update(&es1, {&es2}, {});
+  EXPECT_FALSE(es1.deprioritize);
+  EXPECT_EQ(&ds.selectState(), &es2);
+  ds.update(&es2, {}, {&es2});
+  EXPECT_EQ(&ds.selectState(), &es);
+
+  // and revived afterwards
+  ds.update(&es, {}, {&es});
+  EXPECT_FALSE(ds.empty());
+  EXPECT_EQ(&ds.selectState(), &es1);
+
+  // a duplicate without other states is not paused
+  es1.deprioritize = true;
+  ds.update(&es1, {}, {});
+  EXPECT_EQ(&ds.selectState(), &es1);
+
+  ds.update(&es1, {}, {&es1});
+  EXPECT_TRUE(ds.empty());
+}
+
+TEST(SearcherTest, DeprioritizeRemovedDuplicate) {
+  ExecutionState es;
+  ExecutionState es1(es);
+
+  DeprioritizingSearcher ds(new DFSSearcher());
+  ds.update(nullptr, {&es, &es1}, {});
+
+  es1.deprioritize = true;
+  ds.update(&es1, {}, {});
+  EXPECT_EQ(&ds.selectState(), &es);
+
+  // paused states can be removed
+  ds.update(&es, {}, {&es1});
+  EXPECT_EQ(&ds.selectState(), &es);
+  ds.update(&es, {}, {&es});
+  EXPECT_TRUE(ds.empty());
+}
+
 TEST(SearcherDeathTest, TooManyRandomPaths) {
   // First state
   ExecutionState es;